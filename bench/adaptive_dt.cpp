@@ -0,0 +1,67 @@
+#include "Polygon.hpp"
+#include "SimRunner.hpp"
+#include "SoftBody.hpp"
+#include "StableDt.hpp"
+#include "scenes.hpp"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+
+// One simulated second of the default scene, in the gui's fixed 0.1 ms steps against as large as
+// stay stable, for a body of spring constant range(0). The steps counter is the number taken,
+// the stable counter whether the body came through in one piece.
+
+namespace {
+
+SimState defaultScene(benchmark::State& state) {
+    return SimState{SimBody(Vec2I(25, 25), static_cast<float>(benchGap), {3, 0},
+                            static_cast<float>(state.range(0)), 100),
+                    {Polygon::Square(Vec2(6, 10), -0.75), Polygon::Square(Vec2(14, 10), 0.75)},
+                    benchGravity};
+}
+
+void simulatedSecond(benchmark::State& state, const SimState& start) {
+    std::uint64_t steps  = 0;
+    bool          stable = true;
+    for (auto _: state) {
+        SimState s = start;
+        for (double t = 0; t < 1; t += s.dt) s.run(1);
+        steps  = s.steps;
+        stable = isStable(s.body.getPoints());
+    }
+    state.counters["steps"]  = static_cast<double>(steps);
+    state.counters["stable"] = stable ? 1 : 0;
+}
+
+void springConstants(benchmark::internal::Benchmark* b) {
+    b->Arg(500)->Arg(8000)->Arg(20000)->Unit(benchmark::kMillisecond);
+}
+
+void BM_simSecondFixed(benchmark::State& state) {
+    SimState s = defaultScene(state);
+    s.dt       = benchDt;
+    simulatedSecond(state, s);
+}
+BENCHMARK(BM_simSecondFixed)->Apply(springConstants); // NOLINT
+
+void BM_simSecondAdaptive(benchmark::State& state) {
+    SimState s         = defaultScene(state);
+    s.adaptive.enabled = true;
+    s.adaptive.update(s.body);
+    simulatedSecond(state, s);
+}
+BENCHMARK(BM_simSecondAdaptive)->Apply(springConstants); // NOLINT
+
+// re-deriving the bound, which the runner does after every command
+void BM_stabilityBound(benchmark::State& state) {
+    SimState                     s = defaultScene(state);
+    BasicDtController<SimScalar> adaptive;
+    for (auto _: state) {
+        adaptive.update(s.body);
+        benchmark::DoNotOptimize(adaptive.bound());
+    }
+    state.SetItemsProcessed(state.iterations() *
+                            static_cast<std::int64_t>(s.body.getSprings().size()));
+}
+BENCHMARK(BM_stabilityBound)->Arg(8000); // NOLINT
+
+} // namespace
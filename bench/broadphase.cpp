@@ -0,0 +1,65 @@
+#include "Broadphase.hpp"
+#include "Polygon.hpp"
+#include "SoftBody.hpp"
+#include "scenes.hpp"
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Collision against range(0) small polygons laid at a constant density of one per square unit,
+// so the scene grows with the count while the 50 x 50 body (10 units across) only ever overlaps
+// the hundred or so in its corner. Brute force tests every polygon against every point, the grid
+// just the ones in each point's cell. items_per_second is points x steps per second.
+
+namespace {
+
+constexpr int bodySize = 50;
+
+std::vector<Polygon> scatteredPolygons(benchmark::State& state) {
+    const auto count = static_cast<int>(state.range(0));
+    return benchPolygons(count, std::ceil(std::sqrt(count)));
+}
+
+void setPointSteps(benchmark::State& state, const SoftBody& sb, std::size_t polygons) {
+    state.SetItemsProcessed(state.iterations() *
+                            static_cast<std::int64_t>(sb.getPoints().size()));
+    state.counters["polygons"] = static_cast<double>(polygons);
+}
+
+void BM_collisionBrute(benchmark::State& state) {
+    SoftBody             sb    = benchBody(bodySize);
+    std::vector<Polygon> polys = scatteredPolygons(state);
+    for (auto _: state) {
+        sb.collisionPhase(polys);
+        benchmark::ClobberMemory();
+    }
+    setPointSteps(state, sb, polys.size());
+}
+BENCHMARK(BM_collisionBrute)->RangeMultiplier(10)->Range(1, 10'000); // NOLINT
+
+void BM_collisionGrid(benchmark::State& state) {
+    SoftBody             sb    = benchBody(bodySize);
+    std::vector<Polygon> polys = scatteredPolygons(state);
+    PolygonGrid          grid(polys);
+    for (auto _: state) {
+        sb.collisionPhase(polys, &grid);
+        benchmark::ClobberMemory();
+    }
+    setPointSteps(state, sb, polys.size());
+}
+BENCHMARK(BM_collisionGrid)->RangeMultiplier(10)->Range(1, 10'000); // NOLINT
+
+// the cost of moving polygons: a full rebuild each step
+void BM_gridRebuild(benchmark::State& state) {
+    std::vector<Polygon> polys = scatteredPolygons(state);
+    PolygonGrid          grid;
+    for (auto _: state) {
+        grid.rebuild(polys);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_gridRebuild)->RangeMultiplier(10)->Range(1, 10'000); // NOLINT
+
+} // namespace
@@ -0,0 +1,60 @@
+#include "Checkpoint.hpp"
+#include "SoftBody.hpp"
+#include "scenes.hpp"
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Saving, restoring and resetting an n x n body, n = range(0). bytes_per_second is checkpoint
+// bytes, so save and restore can be compared against plain memcpy speed. Both re-use their
+// buffers, as the app's checkpoint and rewind buttons do.
+
+namespace {
+
+void setBytes(benchmark::State& state, const std::vector<std::byte>& checkpoint) {
+    state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(checkpoint.size()));
+    state.counters["KiB"] = static_cast<double>(checkpoint.size()) / 1024;
+}
+
+void save(const SoftBody& sb, std::vector<std::byte>& checkpoint) {
+    CheckpointWriter writer(checkpoint);
+    sb.save(writer);
+    writer.finish();
+}
+
+void BM_checkpointSave(benchmark::State& state) {
+    SoftBody               sb = benchBody(static_cast<int>(state.range(0)));
+    std::vector<std::byte> checkpoint;
+    for (auto _: state) {
+        save(sb, checkpoint);
+        benchmark::DoNotOptimize(checkpoint.data());
+    }
+    setBytes(state, checkpoint);
+}
+BENCHMARK(BM_checkpointSave)->RangeMultiplier(4)->Range(16, 256); // NOLINT
+
+void BM_checkpointRestore(benchmark::State& state) {
+    SoftBody               sb = benchBody(static_cast<int>(state.range(0)));
+    std::vector<std::byte> checkpoint;
+    save(sb, checkpoint);
+    for (auto _: state) {
+        CheckpointReader reader(checkpoint);
+        sb.restore(reader);
+        benchmark::ClobberMemory();
+    }
+    setBytes(state, checkpoint);
+}
+BENCHMARK(BM_checkpointRestore)->RangeMultiplier(4)->Range(16, 256); // NOLINT
+
+// rebuilding the grid and its springs from scratch, for comparison with a restore
+void BM_checkpointReset(benchmark::State& state) {
+    SoftBody sb = benchBody(static_cast<int>(state.range(0)));
+    for (auto _: state) {
+        sb.reset();
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_checkpointReset)->RangeMultiplier(4)->Range(16, 256); // NOLINT
+
+} // namespace
@@ -0,0 +1,90 @@
+#include "Integrator.hpp"
+#include "Polygon.hpp"
+#include "SoftBody.hpp"
+#include "StableDt.hpp"
+#include "scenes.hpp"
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Cost per step of each integrator, and the largest stable dt it reaches on the default scene
+// (25 x 25 body falling onto the two tilted squares). Simulated seconds per wall second, the
+// figure which decides which integrator is cheapest, is stable_dt x steps per second.
+
+namespace {
+
+std::vector<Polygon> defaultScene() {
+    return {Polygon::Square(Vec2(6, 10), -0.75), Polygon::Square(Vec2(14, 10), 0.75),
+            Polygon::Triangle(Vec2(100, 100))};
+}
+
+SoftBody defaultBody(Integrator integrator) {
+    SoftBody sb(Vec2I(25, 25), 0.2F, Vec2(3, 0), 8000, 100);
+    sb.integrator = integrator;
+    return sb;
+}
+
+void BM_integratorStep(benchmark::State& state) {
+    SoftBody             sb    = defaultBody(static_cast<Integrator>(state.range(0)));
+    std::vector<Polygon> polys = defaultScene();
+    for (auto _: state) sb.simFrame(benchDt, benchGravity, polys);
+    state.SetItemsProcessed(state.iterations() *
+                            static_cast<std::int64_t>(sb.getPoints().size()));
+    state.SetLabel(integratorNames[state.range(0)]);
+}
+BENCHMARK(BM_integratorStep)->DenseRange(0, 3); // NOLINT
+
+// one search per integrator, it is the counter that matters, not the time
+void BM_largestStableDt(benchmark::State& state) {
+    SoftBody             sb    = defaultBody(static_cast<Integrator>(state.range(0)));
+    std::vector<Polygon> polys = defaultScene();
+    double               dt    = 0;
+    for (auto _: state) dt = largestStableDt(sb, polys, benchGravity);
+    state.counters["stable_dt_ms"] = dt * 1000;
+    state.SetLabel(integratorNames[state.range(0)]);
+}
+BENCHMARK(BM_largestStableDt)->DenseRange(0, 3)->Iterations(1)->Unit(benchmark::kSecond); // NOLINT
+
+// Force solver against XPBD at equal visual quality: both advance one 60 Hz frame per iteration,
+// the force solver in the 0.1 ms steps the gui defaults to and XPBD in one step of range(0)
+// constraint iterations. The stretch counter, the mean over springs of |length / rest - 1| at the
+// end, is the quality being held equal. Both start once the body has landed.
+constexpr double frameDt = 1.0 / 60;
+
+double meanStretch(const SoftBody& sb) {
+    const Particles&        ps      = sb.getPoints();
+    std::span<const Spring> springs = sb.getSprings();
+    double                  stretch = 0;
+    for (const Spring& s: springs)
+        stretch += std::abs((ps.pos[s.a] - ps.pos[s.b]).mag() / s.rest - 1);
+    return stretch / static_cast<double>(springs.size());
+}
+
+void frames(benchmark::State& state, SoftBody& sb, double dt) {
+    std::vector<Polygon> polys = defaultScene();
+    const auto           steps = static_cast<int>(std::lround(frameDt / dt));
+    for (int i = 0; i < 120 * steps; i++) sb.simFrame(dt, benchGravity, polys);
+    for (auto _: state) {
+        for (int i = 0; i < steps; i++) sb.simFrame(dt, benchGravity, polys);
+    }
+    state.SetItemsProcessed(state.iterations() *
+                            static_cast<std::int64_t>(sb.getPoints().size()));
+    state.counters["stretch"] = meanStretch(sb);
+}
+
+void BM_frameForceSolver(benchmark::State& state) {
+    SoftBody sb = defaultBody(Integrator::symplecticEuler);
+    frames(state, sb, benchDt);
+}
+BENCHMARK(BM_frameForceSolver)->Unit(benchmark::kMillisecond); // NOLINT
+
+void BM_frameXpbd(benchmark::State& state) {
+    SoftBody sb        = defaultBody(Integrator::xpbd);
+    sb.xpbd.iterations = static_cast<int>(state.range(0));
+    frames(state, sb, frameDt);
+}
+BENCHMARK(BM_frameXpbd)->RangeMultiplier(2)->Range(5, 80)->Unit(benchmark::kMillisecond); // NOLINT
+
+} // namespace
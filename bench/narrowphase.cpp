@@ -0,0 +1,141 @@
+#include "Broadphase.hpp"
+#include "Collision.hpp"
+#include "DistanceField.hpp"
+#include "Polygon.hpp"
+#include "SoftBody.hpp"
+#include "scenes.hpp"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <numbers>
+#include <vector>
+
+// Contact heavy: every point of a 50 x 50 body tested against every polygon whose bounding box
+// holds it, with 100 overlapping regular polygons of range(0) sides packed over the body so most
+// points are inside one or more. Nothing is moved, so each iteration is the same set of queries.
+// items_per_second is point-polygon queries per second for the exact versions, points per second
+// for the distance field. BM_narrowphaseReference is the narrowphase polyContact() replaced, a ray
+// cast per edge for inside and a second pass for the closest edge, kept here to compare against.
+
+namespace {
+
+std::vector<Polygon> packedPolygons(int count, double extent, int sides) {
+    std::vector<Polygon> polys;
+    const int            perRow = static_cast<int>(std::ceil(std::sqrt(count)));
+    const double         cell   = extent / perRow;
+    for (int i = 0; i < count; i++) {
+        Vec2              centre((i % perRow + 0.5) * cell, (i / perRow + 0.5) * cell);
+        std::vector<Vec2> points;
+        for (int s = 0; s < sides; s++) {
+            double a = 2 * std::numbers::pi * s / sides + 0.3 * i; // turned so edges vary
+            points.emplace_back(centre + 0.7 * cell * Vec2(std::cos(a), std::sin(a)));
+        }
+        polys.emplace_back(std::move(points));
+    }
+    return polys;
+}
+
+// The narrowphase as it was before polygons kept their edges, for reference only: it picks the
+// closest point on the edge's infinite line, which can be NaN near corners
+bool rayCast(const Vec2& pos, const Vec2& v1, const Vec2& v2) {
+    if (pos.x < std::min(v1.x, v2.x) || pos.x > std::max(v1.x, v2.x)) return false;
+    const double deltaX = std::abs(v2.x - v1.x);
+    if (deltaX == 0.0) return false; // a vertical edge can't cross a vertical ray
+    const double deltaY = v2.y - v1.y;
+    return std::abs(v1.x - pos.x) / deltaX * deltaY + v1.y > pos.y;
+}
+
+double distToEdge(const Vec2& pos, const Vec2& v1, const Vec2& v2) {
+    const double area = std::abs((v2.x - v1.x) * (v1.y - pos.y) - (v1.x - pos.x) * (v2.y - v1.y));
+    return area / (v1 - v2).mag();
+}
+
+Vec2 closestOnLine(const Vec2& pos, const Vec2& v1, const Vec2& v2, double dist) {
+    const double corner = (v1 - pos).mag();
+    return v1 + std::sqrt(corner * corner - dist * dist) * (v2 - v1).norm();
+}
+
+bool referenceContact(const Vec2& pos, const Polygon& poly, Vec2& closestPos,
+                      double& closestDist) {
+    bool        inside = false;
+    const Vec2& last   = poly.points[poly.pointCount - 1];
+    closestDist        = distToEdge(pos, last, poly.points[0]);
+    closestPos         = closestOnLine(pos, last, poly.points[0], closestDist);
+    if (rayCast(pos, last, poly.points[0])) inside = !inside;
+    for (std::size_t x = 0; x + 1 < poly.pointCount; x++) {
+        const double dist = distToEdge(pos, poly.points[x], poly.points[x + 1]);
+        if (rayCast(pos, poly.points[x], poly.points[x + 1])) inside = !inside;
+        if (closestDist > dist) {
+            closestPos  = closestOnLine(pos, poly.points[x], poly.points[x + 1], dist);
+            closestDist = dist;
+        }
+    }
+    return inside;
+}
+
+template <auto contact>
+void narrowphase(benchmark::State& state) {
+    const int                n     = 50;
+    const int                sides = static_cast<int>(state.range(0));
+    SoftBody                 sb    = benchBody(n);
+    std::vector<Polygon>     polys = packedPolygons(100, n * benchGap, sides);
+    const std::vector<Vec2>& pos   = sb.getPoints().pos;
+
+    std::int64_t queries = 0;
+    std::int64_t inside  = 0;
+    for (const Polygon& poly: polys) {
+        for (const Vec2& p: pos) queries += poly.isBounded(p) ? 1 : 0;
+    }
+    for (auto _: state) {
+        for (const Polygon& poly: polys) {
+            for (const Vec2& p: pos) {
+                if (!poly.isBounded(p)) continue;
+                Vec2   closest;
+                double dist = 0;
+                bool   in   = contact(p, poly, closest, dist);
+                benchmark::DoNotOptimize(closest);
+                inside += in ? 1 : 0;
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * queries);
+    state.counters["inside"] =
+        static_cast<double>(inside) / static_cast<double>(state.iterations() * queries);
+}
+
+void BM_narrowphase(benchmark::State& state) { narrowphase<polyContact>(state); }
+BENCHMARK(BM_narrowphase)->Arg(3)->Arg(4)->Arg(8)->Arg(32); // NOLINT
+
+void BM_narrowphaseReference(benchmark::State& state) { narrowphase<referenceContact>(state); }
+BENCHMARK(BM_narrowphaseReference)->Arg(3)->Arg(4)->Arg(8)->Arg(32); // NOLINT
+
+// The same queries answered by a distance field of range(1) cells per unit instead. It doesn't
+// need a broadphase or care how many edges there are, so every point is one lookup; bytes and
+// the mean depth error against the exact queries are reported alongside.
+void BM_narrowphaseSdf(benchmark::State& state) {
+    const int                n     = 50;
+    const int                sides = static_cast<int>(state.range(0));
+    SoftBody                 sb    = benchBody(n);
+    std::vector<Polygon>     polys = packedPolygons(100, n * benchGap, sides);
+    const std::vector<Vec2>& pos   = sb.getPoints().pos;
+    DistanceField            sdf(polys, static_cast<double>(state.range(1)));
+
+    std::int64_t inside = 0;
+    for (auto _: state) {
+        for (const Vec2& p: pos) {
+            DistanceField::Sample s = sdf.sample(p);
+            benchmark::DoNotOptimize(s);
+            inside += s.dist < 0 ? 1 : 0;
+        }
+    }
+    SdfError err = measureSdfError(sdf, polys, PolygonGrid(polys), pos);
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(pos.size()));
+    state.counters["bytes"]     = static_cast<double>(sdf.bytes());
+    state.counters["meanError"] = err.meanError;
+    state.counters["wrongSide"] = static_cast<double>(err.wrongSide);
+}
+BENCHMARK(BM_narrowphaseSdf)->ArgsProduct({{3, 32}, {4, 16, 64}}); // NOLINT
+
+} // namespace
@@ -0,0 +1,57 @@
+#include "Polygon.hpp"
+#include "SoftBody.hpp"
+#include "ThreadPool.hpp"
+#include "scenes.hpp"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <vector>
+
+// The simFrame scenes in each precision. Float moves half the bytes of double and fits twice as
+// many lanes in a vector, so the gap should open up as the body outgrows the caches.
+// items_per_second is points x steps per second.
+
+namespace {
+
+template <typename T>
+void setPointSteps(benchmark::State& state, const BasicSoftBody<T>& sb) {
+    state.SetItemsProcessed(state.iterations() *
+                            static_cast<std::int64_t>(sb.getPoints().size()));
+    state.counters["points"] = static_cast<double>(sb.getPoints().size());
+}
+
+template <typename T>
+void BM_precisionSimFrame(benchmark::State& state) {
+    const int            n     = static_cast<int>(state.range(0));
+    BasicSoftBody<T>     sb    = benchBody<T>(n);
+    std::vector<Polygon> polys = benchPolygons(3, n * benchGap);
+    for (auto _: state) sb.simFrame(benchDt, benchGravity, polys);
+    setPointSteps(state, sb);
+}
+BENCHMARK_TEMPLATE(BM_precisionSimFrame, double)->RangeMultiplier(4)->Range(16, 256); // NOLINT
+BENCHMARK_TEMPLATE(BM_precisionSimFrame, float)->RangeMultiplier(4)->Range(16, 256);  // NOLINT
+
+template <typename T>
+void BM_precisionSpringPhase(benchmark::State& state) {
+    BasicSoftBody<T> sb = benchBody<T>(static_cast<int>(state.range(0)));
+    for (auto _: state) {
+        sb.springPhase();
+        benchmark::ClobberMemory();
+    }
+    setPointSteps(state, sb);
+}
+BENCHMARK_TEMPLATE(BM_precisionSpringPhase, double)->RangeMultiplier(4)->Range(16, 256); // NOLINT
+BENCHMARK_TEMPLATE(BM_precisionSpringPhase, float)->RangeMultiplier(4)->Range(16, 256);  // NOLINT
+
+template <typename T>
+void BM_precisionIntegrate(benchmark::State& state) {
+    BasicSoftBody<T> sb = benchBody<T>(static_cast<int>(state.range(0)));
+    for (auto _: state) {
+        sb.integratePhase(benchDt, benchGravity);
+        benchmark::ClobberMemory();
+    }
+    setPointSteps(state, sb);
+}
+BENCHMARK_TEMPLATE(BM_precisionIntegrate, double)->RangeMultiplier(4)->Range(16, 256); // NOLINT
+BENCHMARK_TEMPLATE(BM_precisionIntegrate, float)->RangeMultiplier(4)->Range(16, 256);  // NOLINT
+
+} // namespace
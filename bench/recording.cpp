@@ -0,0 +1,75 @@
+#include "Recording.hpp"
+#include "SoftBody.hpp"
+#include "scenes.hpp"
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// The cost of recording every step of an n x n body, n = range(0), against not recording, and of
+// decoding frames for playback. items_per_second is points x steps (or frames) per second.
+
+namespace {
+
+std::string benchPath() {
+    return (std::filesystem::temp_directory_path() / "softbody_bench.rec").string();
+}
+
+void setPointSteps(benchmark::State& state, const SoftBody& sb) {
+    state.SetItemsProcessed(state.iterations() *
+                            static_cast<std::int64_t>(sb.getPoints().size()));
+}
+
+// range(1): 0 not recording, 1 raw floats, 2 quantised to 1e-4
+void BM_recordSimFrame(benchmark::State& state) {
+    SoftBody             sb    = benchBody(static_cast<int>(state.range(0)));
+    std::vector<Polygon> polys = benchPolygons(16, benchGap * static_cast<double>(state.range(0)));
+    PolygonGrid          grid(polys);
+    {
+        RecordOptions options;
+        options.quantum = state.range(1) == 2 ? 1e-4 : 0;
+        Recorder      recorder(benchPath(), sb, polys, benchDt, options);
+        std::uint64_t step = 0;
+        for (auto _: state) {
+            sb.simFrame(benchDt, benchGravity, polys, nullptr, &grid);
+            if (state.range(1) != 0) recorder.record<double>(++step, sb.getPoints().pos);
+        }
+        state.counters["MiB"] = static_cast<double>(recorder.bytesWritten()) / (1024 * 1024);
+    }
+    std::filesystem::remove(benchPath());
+    setPointSteps(state, sb);
+}
+BENCHMARK(BM_recordSimFrame)->ArgsProduct({{32, 128}, {0, 1, 2}}); // NOLINT
+
+// playing a quantised recording straight through
+void BM_replayFrame(benchmark::State& state) {
+    SoftBody             sb    = benchBody(static_cast<int>(state.range(0)));
+    std::vector<Polygon> polys = benchPolygons(16, benchGap * static_cast<double>(state.range(0)));
+    PolygonGrid          grid(polys);
+    {
+        RecordOptions options;
+        options.quantum = 1e-4;
+        Recorder recorder(benchPath(), sb, polys, benchDt, options);
+        for (std::uint64_t step = 1; step <= 512; step++) {
+            sb.simFrame(benchDt, benchGravity, polys, nullptr, &grid);
+            recorder.record<double>(step, sb.getPoints().pos);
+        }
+    }
+    {
+        Replay            replay(benchPath());
+        std::vector<Vec2> pos;
+        std::size_t       frame = 0;
+        for (auto _: state) {
+            replay.frame(frame, pos);
+            frame = (frame + 1) % replay.frames();
+            benchmark::DoNotOptimize(pos.data());
+        }
+    }
+    std::filesystem::remove(benchPath());
+    setPointSteps(state, sb);
+}
+BENCHMARK(BM_replayFrame)->Arg(32)->Arg(128); // NOLINT
+
+} // namespace
@@ -0,0 +1,34 @@
+#include "SoftBody.hpp"
+#include "scenes.hpp"
+#include <benchmark/benchmark.h>
+
+// Dragging the size slider: an n x n body, n = range(0), growing by one row and column and
+// shrinking back, in place with resize() against rebuilding it with reset().
+
+namespace {
+
+void BM_resizeByOne(benchmark::State& state) {
+    const auto n  = static_cast<int>(state.range(0));
+    SoftBody   sb = benchBody(n);
+    for (auto _: state) {
+        sb.resize(Vec2I(n + 1, n + 1));
+        sb.resize(Vec2I(n, n));
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_resizeByOne)->RangeMultiplier(4)->Range(16, 256); // NOLINT
+
+void BM_resetByOne(benchmark::State& state) {
+    const auto n  = static_cast<int>(state.range(0));
+    SoftBody   sb = benchBody(n);
+    for (auto _: state) {
+        sb.size = Vec2I(n + 1, n + 1);
+        sb.reset();
+        sb.size = Vec2I(n, n);
+        sb.reset();
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_resetByOne)->RangeMultiplier(4)->Range(16, 256); // NOLINT
+
+} // namespace
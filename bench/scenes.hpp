@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Polygon.hpp"
+#include "SoftBody.hpp"
+#include "Vector2.hpp"
+#include <cmath>
+#include <vector>
+
+// Shared, deterministic scenes for the benchmarks
+
+inline constexpr double benchGap     = 0.2;
+inline constexpr double benchDt      = 1e-4;
+inline constexpr double benchGravity = 2.0;
+
+// square body of n x n points with its top left corner at the origin, in double by default
+template <typename T = double>
+BasicSoftBody<T> benchBody(int n) {
+    return BasicSoftBody<T>(Vec2I(n, n), static_cast<float>(benchGap), Vector2<T>(0, 0), 8000,
+                            100);
+}
+
+// `count` small triangles spread evenly over a square region `extent` wide, starting at origin.
+// With extent equal to the body's width every point is near some polygon.
+inline std::vector<Polygon> benchPolygons(int count, double extent) {
+    std::vector<Polygon> polys;
+    polys.reserve(static_cast<std::size_t>(count));
+    const int    perRow = static_cast<int>(std::ceil(std::sqrt(count)));
+    const double cell   = extent / perRow;
+    for (int i = 0; i < count; i++) {
+        Vec2 centre((i % perRow + 0.5) * cell, (i / perRow + 0.5) * cell);
+        double r = 0.35 * cell;
+        polys.emplace_back(std::vector<Vec2>{centre + Vec2(r, r), centre + Vec2(-r, r),
+                                             centre + Vec2(0, -r)});
+    }
+    return polys;
+}
@@ -0,0 +1,165 @@
+#include "Polygon.hpp"
+#include "Profiler.hpp"
+#include "SoftBody.hpp"
+#include "ThreadPool.hpp"
+#include "Trace.hpp"
+#include "scenes.hpp"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <vector>
+
+// Every benchmark reports items_per_second as points x steps per second, so results are
+// comparable across body sizes.
+
+namespace {
+
+void setPointSteps(benchmark::State& state, const SoftBody& sb) {
+    state.SetItemsProcessed(state.iterations() *
+                            static_cast<std::int64_t>(sb.getPoints().size()));
+    state.counters["points"] = static_cast<double>(sb.getPoints().size());
+}
+
+// Times step() from the same state every iteration, put back outside the timing, so every
+// iteration does the same work rather than the body falling off the polygons as it goes
+template <typename Step>
+void fromStart(benchmark::State& state, SoftBody& sb, const Step& step) {
+    const SoftBody start = sb;
+    for (auto _: state) {
+        state.PauseTiming();
+        sb = start; // the same sizes, so no allocation
+        state.ResumeTiming();
+        step();
+    }
+}
+
+// the full step, default scene polygons under a body of range(0) x range(0) points
+void BM_simFrame(benchmark::State& state) {
+    const int            n     = static_cast<int>(state.range(0));
+    SoftBody             sb    = benchBody(n);
+    std::vector<Polygon> polys = benchPolygons(3, n * benchGap);
+    fromStart(state, sb, [&] { sb.simFrame(benchDt, benchGravity, polys); });
+    setPointSteps(state, sb);
+}
+BENCHMARK(BM_simFrame)->RangeMultiplier(2)->Range(10, 200); // NOLINT
+
+// the same with a profiler installed, as in the app, so every phase's timer records. Compare with
+// BM_simFrame for their overhead. Only timed at all when built with -DSOFTBODY_PROFILE=ON
+void BM_simFrameProfiled(benchmark::State& state) {
+    const int             n     = static_cast<int>(state.range(0));
+    SoftBody              sb    = benchBody(n);
+    std::vector<Polygon>  polys = benchPolygons(3, n * benchGap);
+    Profiler              profiler;
+    const InstallProfiler profiling(profiler);
+    fromStart(state, sb, [&] { sb.simFrame(benchDt, benchGravity, polys); });
+    setPointSteps(state, sb);
+}
+BENCHMARK(BM_simFrameProfiled)->RangeMultiplier(2)->Range(10, 200); // NOLINT
+
+// and with a tracer recording every phase as an event, in a ring which wraps many times over
+void BM_simFrameTraced(benchmark::State& state) {
+    const int            n     = static_cast<int>(state.range(0));
+    SoftBody             sb    = benchBody(n);
+    std::vector<Polygon> polys = benchPolygons(3, n * benchGap);
+    Tracer               tracer(1024);
+    tracer.start();
+    fromStart(state, sb, [&] { sb.simFrame(benchDt, benchGravity, polys); });
+    tracer.stop();
+    setPointSteps(state, sb);
+}
+BENCHMARK(BM_simFrameTraced)->RangeMultiplier(2)->Range(10, 200); // NOLINT
+
+void BM_simFrameThreaded(benchmark::State& state) {
+    const int            n     = static_cast<int>(state.range(0));
+    SoftBody             sb    = benchBody(n);
+    std::vector<Polygon> polys = benchPolygons(3, n * benchGap);
+    ThreadPool           pool;
+    fromStart(state, sb, [&] { sb.simFrame(benchDt, benchGravity, polys, &pool); });
+    setPointSteps(state, sb);
+    state.counters["threads"] = pool.size();
+}
+BENCHMARK(BM_simFrameThreaded)
+    ->RangeMultiplier(2)
+    ->Range(10, 200)
+    ->UseRealTime();
+
+void BM_springPhase(benchmark::State& state) {
+    SoftBody sb = benchBody(static_cast<int>(state.range(0)));
+    for (auto _: state) {
+        sb.springPhase();
+        benchmark::ClobberMemory();
+        sb.clearForces(); // a memset, small next to the phase, rather than forces piling up
+    }
+    setPointSteps(state, sb);
+}
+BENCHMARK(BM_springPhase)->RangeMultiplier(2)->Range(10, 200)->Arg(100); // NOLINT
+
+void BM_integratePhase(benchmark::State& state) {
+    SoftBody sb = benchBody(static_cast<int>(state.range(0)));
+    for (auto _: state) {
+        sb.integratePhase(benchDt, benchGravity);
+        benchmark::ClobberMemory();
+    }
+    setPointSteps(state, sb);
+}
+BENCHMARK(BM_integratePhase)->RangeMultiplier(2)->Range(10, 200); // NOLINT
+
+// self collision: keeping the cell list up to date and finding every pair of points in reach.
+// Compare with BM_springPhase at the same size for the overhead. The body is at rest, so no point
+// changes cell and the list is never sorted again
+void BM_contactPhase(benchmark::State& state) {
+    SoftBody sb      = benchBody(static_cast<int>(state.range(0)));
+    sb.selfCollision = true; // off by default
+    for (auto _: state) {
+        sb.contactPhase();
+        benchmark::ClobberMemory();
+        sb.clearForces(); // a memset, small next to the phase, rather than forces piling up
+    }
+    setPointSteps(state, sb);
+}
+BENCHMARK(BM_contactPhase)->RangeMultiplier(2)->Range(10, 200)->Arg(100); // NOLINT
+
+// the same with the body falling, so after the first few steps some point changes cell every
+// step and the list is sorted again each time
+void BM_contactPhaseFalling(benchmark::State& state) {
+    SoftBody sb      = benchBody(static_cast<int>(state.range(0)));
+    sb.selfCollision = true;
+    for (auto _: state) {
+        state.PauseTiming();
+        sb.integratePhase(benchDt, 100 * benchGravity); // which clears the forces too
+        state.ResumeTiming();
+        sb.contactPhase();
+        benchmark::ClobberMemory();
+    }
+    setPointSteps(state, sb);
+}
+BENCHMARK(BM_contactPhaseFalling)->Arg(100); // NOLINT
+
+// collision only, 50 x 50 body with range(0) polygons laid over it. The body never moves, so
+// every step does the same amount of work
+void BM_collisionPhase(benchmark::State& state) {
+    const int            n     = 50;
+    SoftBody             sb    = benchBody(n);
+    std::vector<Polygon> polys = benchPolygons(static_cast<int>(state.range(0)), n * benchGap);
+    for (auto _: state) {
+        sb.collisionPhase(polys);
+        benchmark::ClobberMemory();
+    }
+    setPointSteps(state, sb);
+    state.counters["polygons"] = static_cast<double>(polys.size());
+}
+BENCHMARK(BM_collisionPhase)->RangeMultiplier(10)->Range(1, 1000); // NOLINT
+
+// the full step of the same 50 x 50 body in scenes of 1 to 1000 polygons
+void BM_simFrameScene(benchmark::State& state) {
+    const int            n     = 50;
+    SoftBody             sb    = benchBody(n);
+    std::vector<Polygon> polys = benchPolygons(static_cast<int>(state.range(0)), n * benchGap);
+    fromStart(state, sb, [&] { sb.simFrame(benchDt, benchGravity, polys); });
+    setPointSteps(state, sb);
+    state.counters["polygons"] = static_cast<double>(polys.size());
+}
+BENCHMARK(BM_simFrameScene)->RangeMultiplier(10)->Range(1, 1000); // NOLINT
+
+} // namespace
+
+BENCHMARK_MAIN(); // NOLINT
@@ -0,0 +1,77 @@
+#include "Polygon.hpp"
+#include "SoftBody.hpp"
+#include "World.hpp"
+#include "scenes.hpp"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <vector>
+
+// A World of range(0) small bodies which have already come to rest side by side on one long
+// platform, stepped with and without sleeping, and with all but one asleep. Settling happens
+// once, outside the timing. items_per_second is points x steps per second.
+
+namespace {
+
+constexpr int    bodySize = 5;
+constexpr double spacing  = 1.5;
+
+World restingWorld(benchmark::State& state, bool sleeping) {
+    const auto count = static_cast<int>(state.range(0));
+    World      world;
+    world.sleeping = true; // to know when they have all settled
+    world.reserve(static_cast<std::size_t>(count),
+                  static_cast<std::size_t>(count * bodySize * bodySize),
+                  static_cast<std::size_t>(count) * benchBody(bodySize).getSprings().size());
+    for (int i = 0; i < count; i++) {
+        world.add(SoftBody(Vec2I(bodySize, bodySize), static_cast<float>(benchGap),
+                           Vec2(1 + i * spacing, 0), 8000, 100));
+    }
+    const double width = count * spacing + 1; // a little past the row of bodies at each end
+    world.polys.emplace_back(
+        std::vector<Vec2>{Vec2(width, 2.5), Vec2(0, 2.5), Vec2(0, 1.5), Vec2(width, 1.5)});
+
+    auto settled = [&] {
+        for (std::size_t b = 0; b < world.getBodies().size(); b++) {
+            if (!world.asleep(b)) return false;
+        }
+        return true;
+    };
+    for (int i = 0; i < 200'000 && !settled(); i++) world.step();
+    if (!settled()) state.SkipWithError("the bodies didn't come to rest");
+    world.sleeping = sleeping;
+    return world;
+}
+
+void setPointSteps(benchmark::State& state, const World& world) {
+    state.SetItemsProcessed(state.iterations() *
+                            static_cast<std::int64_t>(world.getPoints().size()));
+    state.counters["bodies"] = static_cast<double>(state.range(0));
+}
+
+void BM_restingAwake(benchmark::State& state) {
+    World world = restingWorld(state, false);
+    for (auto _: state) world.step();
+    setPointSteps(state, world);
+}
+BENCHMARK(BM_restingAwake)->RangeMultiplier(10)->Range(10, 100); // NOLINT
+
+void BM_restingAsleep(benchmark::State& state) {
+    World world = restingWorld(state, true);
+    for (auto _: state) world.step();
+    setPointSteps(state, world);
+}
+BENCHMARK(BM_restingAsleep)->RangeMultiplier(10)->Range(10, 100); // NOLINT
+
+// all but one asleep: the awake body is stepped, and the pairs looked through for it touching
+// any of the others
+void BM_restingOneAwake(benchmark::State& state) {
+    World world = restingWorld(state, true);
+    for (auto _: state) {
+        world.wake(0);
+        world.step();
+    }
+    setPointSteps(state, world);
+}
+BENCHMARK(BM_restingOneAwake)->RangeMultiplier(10)->Range(10, 100); // NOLINT
+
+} // namespace
@@ -0,0 +1,74 @@
+#include "Polygon.hpp"
+#include "SoftBody.hpp"
+#include "ThreadPool.hpp"
+#include "World.hpp"
+#include "scenes.hpp"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <vector>
+
+// Scenes of range(0) small 5 x 5 bodies in rows above the default scene's polygons, far enough
+// apart that they don't touch. One World with all of them in its shared pool against the same
+// bodies as separate SoftBody objects stepped one after another. items_per_second is points x
+// steps per second.
+
+namespace {
+
+constexpr int    bodySize = 5;
+constexpr double spacing  = 1.5;
+
+std::vector<SoftBody> manyBodies(benchmark::State& state) {
+    const auto            count = static_cast<int>(state.range(0));
+    std::vector<SoftBody> bodies;
+    bodies.reserve(static_cast<std::size_t>(count));
+    for (int i = 0; i < count; i++) {
+        bodies.emplace_back(Vec2I(bodySize, bodySize), static_cast<float>(benchGap),
+                            Vec2(i % 40 * spacing, i / 40 * spacing), 8000, 100);
+    }
+    return bodies;
+}
+
+World manyBodyWorld(benchmark::State& state) {
+    std::vector<SoftBody> bodies = manyBodies(state);
+    World                 world;
+    world.reserve(bodies.size(), bodies.size() * bodySize * bodySize,
+                  bodies.size() * bodies[0].getSprings().size());
+    for (const SoftBody& sb: bodies) world.add(sb);
+    world.polys = benchPolygons(3, 40 * spacing);
+    return world;
+}
+
+void setPointSteps(benchmark::State& state, std::size_t points) {
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(points));
+    state.counters["bodies"] = static_cast<double>(state.range(0));
+}
+
+void BM_worldStep(benchmark::State& state) {
+    World world = manyBodyWorld(state);
+    for (auto _: state) world.step();
+    setPointSteps(state, world.getPoints().size());
+}
+BENCHMARK(BM_worldStep)->RangeMultiplier(10)->Range(10, 1000); // NOLINT
+
+void BM_worldStepThreaded(benchmark::State& state) {
+    World      world = manyBodyWorld(state);
+    ThreadPool pool;
+    for (auto _: state) world.step(&pool);
+    setPointSteps(state, world.getPoints().size());
+    state.counters["threads"] = pool.size();
+}
+BENCHMARK(BM_worldStepThreaded)->RangeMultiplier(10)->Range(10, 1000)->UseRealTime(); // NOLINT
+
+// the same bodies and polygons without a World: no contact between bodies, so less work
+void BM_separateBodies(benchmark::State& state) {
+    std::vector<SoftBody> bodies = manyBodies(state);
+    std::vector<Polygon>  polys  = benchPolygons(3, 40 * spacing);
+    PolygonGrid           grid(polys);
+    for (auto _: state) {
+        for (SoftBody& sb: bodies) sb.simFrame(benchDt, benchGravity, polys, nullptr, &grid);
+    }
+    setPointSteps(state, bodies.size() * bodySize * bodySize);
+}
+BENCHMARK(BM_separateBodies)->RangeMultiplier(10)->Range(10, 1000); // NOLINT
+
+} // namespace
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "Polygon.hpp"
+#include "Vector2.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Uniform grid over the bounding boxes of a set of static polygons, so each particle only tests
+// the few polygons near it instead of every polygon in the scene. Cells are stored flat: cell c's
+// polygons are items[starts[c], starts[c + 1]), in ascending index order, so testing them in that
+// order gives exactly the same result as looping over every polygon.
+//
+// The grid copies nothing but bounds, so call rebuild() whenever the polygons move or change.
+// It is a counting sort over the polygons' cells, so linear in their number.
+class PolygonGrid {
+  public:
+    PolygonGrid() = default;
+
+    explicit PolygonGrid(std::span<const Polygon> polys, double cellSize = 0) {
+        rebuild(polys, cellSize);
+    }
+
+    // cellSize 0 picks one from the polygons: the mean of their bounding boxes' longer sides
+    void rebuild(std::span<const Polygon> polys, double cellSize = 0) {
+        count = polys.size();
+        cols  = 0;
+        rows  = 0;
+        starts.assign(1, 0);
+        items.clear();
+        if (polys.empty()) return;
+
+        Vec2   lo  = polys[0].minBounds;
+        Vec2   hi  = polys[0].maxBounds;
+        double sum = 0;
+        for (const Polygon& poly: polys) {
+            lo.x = std::min(lo.x, poly.minBounds.x);
+            lo.y = std::min(lo.y, poly.minBounds.y);
+            hi.x = std::max(hi.x, poly.maxBounds.x);
+            hi.y = std::max(hi.y, poly.maxBounds.y);
+            sum += std::max(poly.maxBounds.x - poly.minBounds.x,
+                            poly.maxBounds.y - poly.minBounds.y);
+        }
+        cell = cellSize > 0 ? cellSize : sum / static_cast<double>(polys.size());
+        if (!(cell > 0)) cell = 1; // only points in the scene
+
+        // a few stray far away polygons mustn't blow up the cell count: grow the cells instead
+        const double maxCells = std::max(4096.0, 4.0 * static_cast<double>(polys.size()));
+        const double area     = (hi.x - lo.x) / cell * (hi.y - lo.y) / cell;
+        if (area > maxCells) cell *= std::sqrt(area / maxCells);
+
+        origin  = lo;
+        invCell = 1 / cell;
+        cols    = cellOf(hi.x, origin.x) + 1;
+        rows    = cellOf(hi.y, origin.y) + 1;
+
+        starts.assign(static_cast<std::size_t>(cols * rows) + 1, 0);
+        forEachCell(polys, [&](std::size_t c, std::uint32_t) { ++starts[c + 1]; });
+        for (std::size_t c = 1; c < starts.size(); c++) starts[c] += starts[c - 1];
+        items.resize(starts.back());
+        std::vector<std::uint32_t> next(starts.begin(), starts.end() - 1);
+        forEachCell(polys, [&](std::size_t c, std::uint32_t p) { items[next[c]++] = p; });
+    }
+
+    [[nodiscard]] std::size_t polygonCount() const { return count; }
+
+    // indices, ascending, of every polygon whose bounding box overlaps the cell pos is in
+    [[nodiscard]] std::span<const std::uint32_t> near(const Vec2& pos) const {
+        const int x = cellOf(pos.x, origin.x);
+        const int y = cellOf(pos.y, origin.y);
+        if (x < 0 || y < 0 || x >= cols || y >= rows) return {};
+        const auto c = static_cast<std::size_t>(x + y * cols);
+        return std::span(items).subspan(starts[c], starts[c + 1] - starts[c]);
+    }
+
+    // Calls fn(poly) for each polygon whose bounding box contains pos, in index order, exactly as
+    // looping over every polygon and testing isBounded() would. fn may move pos: if that takes it
+    // into another cell the rest of the polygons are taken from there. pos may be in either
+    // precision.
+    template <typename T, typename Fn>
+    void forEachBounding(std::span<const Polygon> polys, const Vector2<T>& pos, Fn&& fn) const {
+        std::span<const std::uint32_t> cand = near(Vec2(pos));
+        std::uint32_t                  next = 0; // polygons before this one have had their turn
+        for (std::size_t i = 0; i < cand.size(); i++) {
+            const std::uint32_t p = cand[i];
+            if (p < next || !polys[p].isBounded(Vec2(pos))) continue;
+            next = p + 1;
+            fn(polys[p]);
+            std::span<const std::uint32_t> moved = near(Vec2(pos));
+            if (moved.data() != cand.data() || moved.size() != cand.size()) {
+                cand = moved;
+                i    = static_cast<std::size_t>(-1); // restart, skipping anything below next
+            }
+        }
+    }
+
+  private:
+    Vec2                       origin;
+    double                     cell    = 1;
+    double                     invCell = 1;
+    int                        cols    = 0;
+    int                        rows    = 0;
+    std::size_t                count   = 0;
+    std::vector<std::size_t>   starts{0};
+    std::vector<std::uint32_t> items;
+
+    [[nodiscard]] int cellOf(double v, double o) const {
+        double c = std::floor((v - o) * invCell);
+        if (!(c >= 0)) return -1;                  // also nan
+        return static_cast<int>(std::min(c, 1e9)); // clamped so the cast is safe
+    }
+
+    // calls fn(cell, polygon index) for every cell each polygon's bounding box overlaps
+    template <typename Fn>
+    void forEachCell(std::span<const Polygon> polys, Fn&& fn) const {
+        for (std::size_t p = 0; p < polys.size(); p++) {
+            const int x0 = cellOf(polys[p].minBounds.x, origin.x);
+            const int y0 = cellOf(polys[p].minBounds.y, origin.y);
+            const int x1 = cellOf(polys[p].maxBounds.x, origin.x);
+            const int y1 = cellOf(polys[p].maxBounds.y, origin.y);
+            for (int y = y0; y <= y1; y++) {
+                for (int x = x0; x <= x1; x++)
+                    fn(static_cast<std::size_t>(x + y * cols), static_cast<std::uint32_t>(p));
+            }
+        }
+    }
+};
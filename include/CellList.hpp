@@ -0,0 +1,247 @@
+#pragma once
+
+#include "Particles.hpp"
+#include "ThreadPool.hpp"
+#include "Vector2.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+// Cell list for particle-particle contact, kept up to date every step. Particles are binned into
+// square cells at least as wide as the contact distance, then counting sorted by cell, row
+// major, with a copy of their positions kept in that order. Any pair which can touch is then in
+// the same or neighbouring cells. Taking each pair once, from the cell of the particle earlier in
+// the sorted order, the candidates for a particle are the rest of its own cell and the cell to
+// its right, which sit next to each other in the sorted order, and the three cells below it,
+// which do too. Building and querying are both linear in the number of particles. T is the
+// precision of the positions.
+//
+// Cells are squares of one fixed lattice for a given width, whatever the particles' bounds, so
+// a particle's cell only depends on where it is. While the particles are at or near rest none
+// leaves its cell from one step to the next, and then the sort is kept and only the sorted copy
+// of the positions is refreshed. Either way the pairs and their order are exactly those of a
+// list built from scratch, so results don't depend on what the list held before.
+template <typename T>
+class BasicCellList {
+  public:
+    // reach is the distance within which two particles count as a pair. Cells are made wider if
+    // the particles spread out enough that there would be more than a few cells per particle
+    void build(std::span<const Vector2<T>> pos, T reach) {
+        const std::size_t n = pos.size();
+        reach2              = reach * reach;
+        Vector2<T> lo;
+        Vector2<T> hi;
+        // at rest no particle has left its cell, and one pass finds that and the bounds
+        const bool kept = n > 0 && n == sorted.size() && resort(pos, lo, hi);
+        if (n == 0 || !(kept || bounds(pos, lo, hi))) return clear(); // none, or blown up
+
+        T       cell     = reach;
+        const T maxCells = 4 * static_cast<T>(n) + 64;
+        const T area     = (hi.x - lo.x + cell) * (hi.y - lo.y + cell) / (cell * cell);
+        if (!std::isfinite(area)) return clear(); // spread past the range of T, so blown up too
+        // in steps of sqrt 2, so the width stays put while the particles spread a little
+        if (area > maxCells) cell *= std::exp2(std::ceil(std::log2(area / maxCells)) / 2);
+        const T far = std::max(std::max(std::abs(lo.x), std::abs(hi.x)),
+                               std::max(std::abs(lo.y), std::abs(hi.y)));
+        if (!(far / cell < T(1e15))) return clear(); // past where lattice indices are exact
+        if (kept && cell == width && far / cell < exact) return;
+
+        width   = cell;
+        invCell = 1 / cell;
+        // an empty column either side and row below, so no neighbour lookup needs bounds checks.
+        // Starting on an even row, so forEachPair()'s two passes split the same rows every time
+        x0   = lattice(lo.x) - 1;
+        y0   = lattice(lo.y);
+        y0   = y0 - (y0 & 1);
+        cols = static_cast<int>(lattice(hi.x) - x0) + 2;
+        rows = static_cast<int>(lattice(hi.y) - y0) + 2;
+
+        // counted into each cell's end, then filled backwards so each end becomes its start
+        cellOf.resize(n);
+        corner.resize(n);
+        starts.assign(static_cast<std::size_t>(cols * rows) + 1, 0);
+        for (std::size_t i = 0; i < n; i++) {
+            const std::int64_t x = lattice(pos[i].x);
+            const std::int64_t y = lattice(pos[i].y);
+            cellOf[i]            = static_cast<std::uint32_t>((x - x0) + (y - y0) * cols);
+            corner[i]            = Vector2<T>(static_cast<T>(x), static_cast<T>(y));
+            ++starts[cellOf[i]];
+        }
+        std::uint32_t sum = 0; // a running total, not reloading the previous cell's
+        for (std::uint32_t& s: starts) s = sum += s;
+        sorted.resize(n);
+        slotCell.resize(n);
+        at.resize(n);
+        for (std::size_t i = n; i-- > 0;) {
+            const std::uint32_t k = --starts[cellOf[i]];
+            sorted[k]             = static_cast<std::uint32_t>(i);
+            slotCell[k]           = cellOf[i];
+            at[k]                 = pos[i];
+        }
+    }
+
+    // Calls fn(i, j) once for every pair of particles closer than reach when this was built, in
+    // a fixed order. Pairs are found a row of cells at a time, every other row at once and then
+    // the rest, so that no two calls running at the same time on different threads share a
+    // particle and each particle sees its pairs in the same order whatever the pool.
+    template <typename Fn>
+    void forEachPair(ThreadPool* pool, Fn&& fn) const {
+        for (int parity = 0; parity < 2; parity++) {
+            const auto count = static_cast<std::size_t>((rows - parity + 1) / 2);
+            parallelFor(
+                pool, count,
+                [&](std::size_t begin, std::size_t end) {
+                    for (std::size_t r = begin; r < end; r++)
+                        pairsInRow(static_cast<std::size_t>(parity) + 2 * r, fn);
+                },
+                minRowChunk);
+        }
+    }
+
+  private:
+    static constexpr std::size_t minRowChunk = 4;
+    static constexpr std::size_t checkEvery  = 64; // slots resort() goes between giving up
+    // lattice indices below this, and one more, are exact in T, so resort() can compare with them
+    static constexpr T exact = T(std::int64_t{1} << (std::numeric_limits<T>::digits - 1));
+
+    T                          width   = 0; // of a cell, 0 when there are none
+    T                          invCell = 1;
+    T                          reach2  = 0;
+    std::int64_t               x0      = 0; // lattice column and row of cell 0
+    std::int64_t               y0      = 0;
+    int                        cols    = 0;
+    int                        rows    = 0;
+    std::vector<std::uint32_t> cellOf;   // per particle
+    std::vector<Vector2<T>>    corner;   // per particle, the lattice column and row of its cell
+    std::vector<std::uint32_t> starts;   // per cell, into sorted
+    std::vector<std::uint32_t> sorted;   // particle indices, grouped by cell
+    std::vector<std::uint32_t> slotCell; // cell of each of sorted
+    std::vector<Vector2<T>>    at;       // positions in sorted order, for cache friendly queries
+
+    void clear() {
+        width = 0;
+        cols  = 0;
+        rows  = 0;
+        starts.assign(1, 0);
+    }
+
+    // which column or row of the lattice v is in, rounding down without a library call
+    std::int64_t lattice(T v) const {
+        const T    scaled = v * invCell;
+        const auto i      = static_cast<std::int64_t>(scaled);
+        return static_cast<T>(i) > scaled ? i - 1 : i;
+    }
+
+    // Refreshes the sorted copy of the positions and finds their bounding box, and returns true
+    // if every one of pos is still in the cell it was sorted into, which means it is finite too.
+    // Otherwise gives up early and leaves the list for build() to redo. Compares with each cell's
+    // corner rather than rounding, in sorted order
+    bool resort(std::span<const Vector2<T>> pos, Vector2<T>& lo, Vector2<T>& hi) {
+        bool       same = true;
+        Vector2<T> low  = pos[sorted[0]]; // not lo and hi, which writing at[] might alias
+        Vector2<T> high = low;
+        for (std::size_t k = 0; k < sorted.size(); k++) {
+            const Vector2<T> p = pos[sorted[k]];
+            const Vector2<T> c = corner[sorted[k]];
+            const T          x = p.x * invCell; // as lattice() scales it
+            const T          y = p.y * invCell;
+            at[k]              = p;
+            grow(p, low, high);
+            same &= (x >= c.x) & (x < c.x + 1) & (y >= c.y) & (y < c.y + 1);
+            if (k % checkEvery == 0 && !same) return false; // moving, so rebuilt anyway
+        }
+        lo = low;
+        hi = high;
+        return same;
+    }
+
+    // Bounding box of pos, which mustn't be empty, and false if any of it isn't finite. Even and
+    // odd points go into separate boxes so the two sets of min/max chains run side by side,
+    // which is twice as fast
+    static bool bounds(std::span<const Vector2<T>> pos, Vector2<T>& lo, Vector2<T>& hi) {
+        Vector2<T> lo2  = pos[0];
+        Vector2<T> hi2  = pos[0];
+        T          sum  = 0; // nan or inf if any point is, as the comparisons drop nans
+        T          sum2 = 0;
+        lo              = pos[0];
+        hi              = pos[0];
+        for (std::size_t i = 0; i < pos.size(); i += 2) {
+            grow(pos[i], lo, hi);
+            sum += pos[i].x + pos[i].y;
+            if (i + 1 < pos.size()) {
+                grow(pos[i + 1], lo2, hi2);
+                sum2 += pos[i + 1].x + pos[i + 1].y;
+            }
+        }
+        grow(lo2, lo, hi);
+        grow(hi2, lo, hi);
+        return std::isfinite(sum + sum2 + lo.x + lo.y + hi.x + hi.y);
+    }
+
+    static void grow(const Vector2<T>& p, Vector2<T>& lo, Vector2<T>& hi) {
+        lo.x = p.x < lo.x ? p.x : lo.x;
+        lo.y = p.y < lo.y ? p.y : lo.y;
+        hi.x = p.x > hi.x ? p.x : hi.x;
+        hi.y = p.y > hi.y ? p.y : hi.y;
+    }
+
+    template <typename Fn>
+    void pairsInRow(std::size_t row, Fn& fn) const {
+        const auto w    = static_cast<std::size_t>(cols);
+        const auto last = starts[(row + 1) * w];
+        for (std::uint32_t k = starts[row * w]; k < last; k++) {
+            const Vector2<T>  p = at[k];
+            const std::size_t c = slotCell[k];
+            // this cell after k and the one right of it, then the three below
+            pairsIn(k + 1, starts[c + 2], p, sorted[k], fn);
+            pairsIn(starts[c + w - 1], starts[c + w + 2], p, sorted[k], fn);
+        }
+    }
+
+    template <typename Fn>
+    void pairsIn(std::uint32_t begin, std::uint32_t end, const Vector2<T>& p, std::uint32_t i,
+                 Fn& fn) const {
+        for (std::uint32_t m = begin; m < end; m++) {
+            const Vector2<T> d = at[m] - p;
+            if (d.dot(d) < reach2) fn(i, sorted[m]);
+        }
+    }
+};
+
+using CellList  = BasicCellList<double>;
+using CellListF = BasicCellList<float>;
+
+// Penalty contact between particles i and j closer than reach(i, j): a compression only spring
+// of stiffness k with damping along the line between them, pushing them apart. The damping only
+// ever takes away from the push, so two points separating faster than the spring pushes them are
+// left alone rather than pulled back together. cells must have been built over ps.pos with a
+// reach of at least the largest reach(i, j).
+template <typename T, typename Reach>
+void contactForces(BasicParticles<T>& ps, const BasicCellList<T>& cells, std::type_identity_t<T> k,
+                   std::type_identity_t<T> damp, ThreadPool* pool, const Reach& reach) {
+    cells.forEachPair(pool, [&](std::uint32_t i, std::uint32_t j) {
+        const Vector2<T> d     = ps.pos[j] - ps.pos[i];
+        const T          touch = reach(i, j);
+        const T          d2    = d.dot(d);
+        if (d2 >= touch * touch || d2 == 0) return;
+        const T          dist = std::sqrt(d2);
+        const Vector2<T> n    = d / dist; // i to j
+        const T          vn   = n.dot(ps.vel[j] - ps.vel[i]);
+        const Vector2<T> f    = n * std::min(T(0), -k * (touch - dist) + damp * vn);
+        ps.f[i] += f;
+        ps.f[j] -= f;
+    });
+}
+
+// between particles closer than the sum of their radii
+template <typename T>
+void contactForces(BasicParticles<T>& ps, const BasicCellList<T>& cells, std::type_identity_t<T> k,
+                   std::type_identity_t<T> damp, ThreadPool* pool) {
+    contactForces(ps, cells, k, damp, pool,
+                  [&](std::uint32_t i, std::uint32_t j) { return ps.radius[i] + ps.radius[j]; });
+}
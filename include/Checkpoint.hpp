@@ -0,0 +1,169 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Compact binary checkpoints of simulation state. Plain data is written back to back in the
+// machine's own byte order, arrays as a count and then their elements, with no field names or
+// padding, so a checkpoint is little more than the bytes of the arrays themselves. It is only
+// meant to be read back by the same build of the same program, and the header checks that much:
+// a format version, the size of everything after the header and a checksum of it.
+
+inline constexpr std::array<char, 4> checkpointMagic{'S', 'B', 'C', 'K'};
+inline constexpr std::uint32_t       checkpointVersion = 6;
+
+// Of a payload, so one damaged on disk is refused rather than restored. Not cryptographic: FNV-1a
+// over 8 byte words, one multiply per word. Each step is a bijection of the running hash, so any
+// one damaged word is always caught
+inline std::uint64_t checkpointChecksum(std::span<const std::byte> bytes) {
+    constexpr std::uint64_t prime = 0x100000001b3;
+    std::uint64_t           hash  = 0xcbf29ce484222325;
+    std::size_t             i     = 0;
+    for (; i + sizeof hash <= bytes.size(); i += sizeof hash) {
+        std::uint64_t word = 0;
+        std::memcpy(&word, bytes.data() + i, sizeof word);
+        hash = (hash ^ word) * prime;
+    }
+    for (; i < bytes.size(); i++) hash = (hash ^ std::to_integer<std::uint64_t>(bytes[i])) * prime;
+    return hash;
+}
+
+// Appends to a byte buffer, which is cleared first but keeps its capacity, so checkpointing into
+// the same buffer again doesn't allocate. Other formats built from the same pieces pass their own
+// magic and version.
+class CheckpointWriter {
+  public:
+    explicit CheckpointWriter(std::vector<std::byte>& out_,
+                              std::array<char, 4> magic   = checkpointMagic,
+                              std::uint32_t       version = checkpointVersion)
+        : out(out_) {
+        out.clear();
+        put(magic);
+        put(version);
+        put(std::uint64_t{0}); // the payload size and its checksum, filled in by finish()
+        put(std::uint64_t{0});
+    }
+
+    template <typename T>
+    void put(const T& v) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        append(&v, sizeof v);
+    }
+
+    template <typename T>
+    void putArray(std::span<const T> v) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        put(static_cast<std::uint64_t>(v.size()));
+        append(v.data(), v.size_bytes());
+    }
+
+    // call once everything is written
+    void finish() {
+        const std::uint64_t payload  = out.size() - headerSize;
+        const std::uint64_t checksum = checkpointChecksum(std::span(out).subspan(headerSize));
+        std::memcpy(out.data() + sizeAt, &payload, sizeof payload);
+        std::memcpy(out.data() + sizeAt + sizeof payload, &checksum, sizeof checksum);
+    }
+
+    // where the payload size is, followed by its checksum
+    static constexpr std::size_t sizeAt     = sizeof checkpointMagic + sizeof checkpointVersion;
+    static constexpr std::size_t headerSize = sizeAt + 2 * sizeof(std::uint64_t);
+
+  private:
+    std::vector<std::byte>& out;
+
+    void append(const void* p, std::size_t n) {
+        const std::size_t old = out.size();
+        out.resize(old + n);
+        std::memcpy(out.data() + old, p, n);
+    }
+};
+
+// Reads back what a CheckpointWriter wrote, in the same order. Throws std::runtime_error from the
+// constructor if the header doesn't match, so a checkpoint from another version, one which was
+// cut short or one whose bytes were damaged is refused before anything is read.
+class CheckpointReader {
+  public:
+    explicit CheckpointReader(std::span<const std::byte> in_,
+                              std::array<char, 4> magic   = checkpointMagic,
+                              std::uint32_t       version = checkpointVersion)
+        : in(in_) {
+        if (in.size() < CheckpointWriter::headerSize || get<std::array<char, 4>>() != magic)
+            throw std::runtime_error("checkpoint: not a checkpoint");
+        if (get<std::uint32_t>() != version)
+            throw std::runtime_error("checkpoint: from another version");
+        if (get<std::uint64_t>() != in.size() - CheckpointWriter::headerSize)
+            throw std::runtime_error("checkpoint: truncated");
+        if (get<std::uint64_t>() != checkpointChecksum(in.subspan(at)))
+            throw std::runtime_error("checkpoint: damaged");
+    }
+
+    template <typename T>
+    T get() {
+        T v;
+        get(v);
+        return v;
+    }
+
+    template <typename T>
+    void get(T& v) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        take(&v, sizeof v);
+    }
+
+    // into v, re-using its allocation when it is already big enough
+    template <typename T>
+    void getArray(std::vector<T>& v) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        const auto n = get<std::uint64_t>();
+        if (n > (in.size() - at) / sizeof(T)) throw std::runtime_error("checkpoint: corrupt");
+        v.resize(static_cast<std::size_t>(n));
+        take(v.data(), v.size() * sizeof(T));
+    }
+
+  private:
+    std::span<const std::byte> in;
+    std::size_t                at = 0;
+
+    void take(void* p, std::size_t n) {
+        if (n > in.size() - at) throw std::runtime_error("checkpoint: corrupt");
+        std::memcpy(p, in.data() + at, n);
+        at += n;
+    }
+};
+
+// The size of the whole block a CheckpointWriter wrote at the start of `in`, header included, for
+// one which is followed by other data. 0 if in is too short to say
+inline std::size_t checkpointSize(std::span<const std::byte> in) {
+    std::uint64_t payload = 0;
+    if (in.size() < CheckpointWriter::headerSize) return 0;
+    std::memcpy(&payload, in.data() + CheckpointWriter::sizeAt, sizeof payload);
+    if (payload > in.size() - CheckpointWriter::headerSize) return 0;
+    return CheckpointWriter::headerSize + static_cast<std::size_t>(payload);
+}
+
+// whole checkpoints to and from disk. Both throw std::runtime_error if the file can't be used
+inline void saveCheckpointFile(const std::string& path, std::span<const std::byte> checkpoint) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(checkpoint.data()), // NOLINT byte access
+               static_cast<std::streamsize>(checkpoint.size()));
+    if (!file) throw std::runtime_error("checkpoint: could not write " + path);
+}
+
+inline void loadCheckpointFile(const std::string& path, std::vector<std::byte>& checkpoint) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) throw std::runtime_error("checkpoint: could not open " + path);
+    checkpoint.resize(static_cast<std::size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(checkpoint.data()), // NOLINT byte access
+              static_cast<std::streamsize>(checkpoint.size()));
+    if (!file) throw std::runtime_error("checkpoint: could not read " + path);
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "Line.hpp"
+#include "Polygon.hpp"
+#include "Vector2.hpp"
+#include <cmath>
+#include <limits>
+
+// True if pos is inside poly, in which case closestPos is the nearest point on its surface and
+// closestDist the distance to it. One pass over the precomputed edges does both: a crossing
+// count along a ray in +x for inside, and projection onto each segment for the closest point.
+inline bool polyContact(const Vec2& pos, const Polygon& poly, Vec2& closestPos,
+                        double& closestDist) {
+    bool   inside = false;
+    double best   = std::numeric_limits<double>::infinity(); // squared distance
+    for (const Line<double>& edge: poly.edges) {
+        // the ray crosses an edge heading +y when pos is on its normal side, and one heading -y
+        // when it is on the other. Half open in y so a ray through a vertex counts once
+        const bool up = edge.start.y <= pos.y && edge.end.y > pos.y;
+        const bool dn = edge.end.y <= pos.y && edge.start.y > pos.y;
+        if (up || dn) {
+            const double side = edge.side(pos);
+            if (up ? side > 0 : side < 0) inside = !inside;
+        }
+        const Vec2   c    = edge.closest(pos);
+        const Vec2   diff = pos - c;
+        const double d2   = diff.dot(diff);
+        if (d2 < best) {
+            best       = d2;
+            closestPos = c;
+        }
+    }
+    closestDist = std::sqrt(best);
+    return inside;
+}
+
+// if pos is inside poly, moves it onto the closest edge and reflects vel about that edge
+inline void polyColHandler(Vec2& pos, Vec2& vel, const Polygon& poly) {
+    Vec2   closestPos;
+    double closestDist = 0;
+    if (polyContact(pos, poly, closestPos, closestDist)) {
+        if (closestDist > 1e-10) { // to prevent the norm() dividing by ~ 0
+            Vec2 normal = (closestPos - pos);
+            normal      = normal.norm();
+            vel -= (2 * normal.dot(vel) * normal);
+            pos = closestPos;
+        }
+    }
+}
+
+// position only version for constraint solvers: if pos is inside poly, moves it onto the
+// closest edge. Velocity is left for the solver to derive from the move
+inline void polyProject(Vec2& pos, const Polygon& poly) {
+    Vec2   closestPos;
+    double closestDist = 0;
+    if (polyContact(pos, poly, closestPos, closestDist)) pos = closestPos;
+}
+
+// Bodies in another precision against the same double polygons: the point is widened for the
+// test and narrowed back only if it moved, so one outside every polygon is left bit for bit
+template <typename T>
+void polyColHandler(Vector2<T>& pos, Vector2<T>& vel, const Polygon& poly) {
+    Vec2 p(pos);
+    Vec2 v(vel);
+    polyColHandler(p, v, poly);
+    if (p == Vec2(pos)) return;
+    pos = Vector2<T>(p);
+    vel = Vector2<T>(v);
+}
+
+template <typename T>
+void polyProject(Vector2<T>& pos, const Polygon& poly) {
+    Vec2 p(pos);
+    polyProject(p, poly);
+    pos = Vector2<T>(p);
+}
@@ -0,0 +1,220 @@
+#pragma once
+
+#include "Broadphase.hpp"
+#include "Collision.hpp"
+#include "Polygon.hpp"
+#include "Vector2.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+// Signed distance to the nearest polygon: negative inside, so -depth. Exact, one pass over the
+// polygon's edges
+inline double polyDistance(const Vec2& pos, const Polygon& poly) {
+    Vec2   closest;
+    double dist = 0;
+    return polyContact(pos, poly, closest, dist) ? -dist : dist;
+}
+
+// A baked signed distance field over a set of static polygons, answering "am I inside, how deep
+// and which way is out" with one bilinear lookup instead of a walk over every edge of every
+// polygon nearby.
+//
+// Only the neighbourhood of the polygons is stored: the space is split into tiles of
+// tileCells x tileCells cells and only tiles within a couple of cells of some polygon's bounds
+// get any samples. A tile holds one more row and column of samples than it has cells, so a
+// lookup never straddles two tiles. Samples are floats, and resolution (cells per unit length)
+// trades memory, quadratically, for accuracy at corners and thin features.
+//
+// Overlapping polygons are combined by taking the smaller distance, which is exact outside them
+// and a slight underestimate of depth where they overlap.
+class DistanceField {
+  public:
+    static constexpr int tileCells = 8;
+
+    struct Sample {
+        double dist; // signed, negative inside. +infinity away from every polygon
+        Vec2   grad; // of dist, so points out. Not normalised
+    };
+
+    DistanceField() = default;
+
+    DistanceField(std::span<const Polygon> polys, double resolution) { build(polys, resolution); }
+
+    void build(std::span<const Polygon> polys, double resolution) {
+        res = resolution;
+        baked.clear();
+        for (const Polygon& poly: polys) {
+            baked.insert(baked.end(), poly.points.begin(), poly.points.end());
+            baked.emplace_back(std::numeric_limits<double>::quiet_NaN(), 0); // separator
+        }
+        tilesX = 0;
+        tilesY = 0;
+        tileIndex.clear();
+        samples.clear();
+        count = polys.size();
+        if (polys.empty()) return;
+
+        const double band = 2 / res; // enough outside the bounds for a gradient at the surface
+        Vec2         lo   = polys[0].minBounds;
+        Vec2         hi   = polys[0].maxBounds;
+        for (const Polygon& poly: polys) {
+            lo.x = std::min(lo.x, poly.minBounds.x);
+            lo.y = std::min(lo.y, poly.minBounds.y);
+            hi.x = std::max(hi.x, poly.maxBounds.x);
+            hi.y = std::max(hi.y, poly.maxBounds.y);
+        }
+        origin            = lo - Vec2(band, band);
+        const double tile = tileCells / res; // tile size in units
+        tilesX            = static_cast<int>((hi.x + band - origin.x) / tile) + 1;
+        tilesY            = static_cast<int>((hi.y + band - origin.y) / tile) + 1;
+
+        // which polygons each tile needs
+        std::vector<std::vector<std::uint32_t>> near(static_cast<std::size_t>(tilesX * tilesY));
+        for (std::size_t p = 0; p < polys.size(); p++) {
+            const int x0 = static_cast<int>((polys[p].minBounds.x - band - origin.x) / tile);
+            const int y0 = static_cast<int>((polys[p].minBounds.y - band - origin.y) / tile);
+            const int x1 = static_cast<int>((polys[p].maxBounds.x + band - origin.x) / tile);
+            const int y1 = static_cast<int>((polys[p].maxBounds.y + band - origin.y) / tile);
+            for (int y = std::max(y0, 0); y <= std::min(y1, tilesY - 1); y++) {
+                for (int x = std::max(x0, 0); x <= std::min(x1, tilesX - 1); x++)
+                    near[static_cast<std::size_t>(x + y * tilesX)].push_back(
+                        static_cast<std::uint32_t>(p));
+            }
+        }
+
+        tileIndex.assign(near.size(), -1);
+        for (std::size_t t = 0; t < near.size(); t++) {
+            if (near[t].empty()) continue;
+            tileIndex[t] = static_cast<std::int32_t>(samples.size() / tileSamples);
+            const int tx = static_cast<int>(t % static_cast<std::size_t>(tilesX));
+            const int ty = static_cast<int>(t / static_cast<std::size_t>(tilesX));
+            for (int j = 0; j <= tileCells; j++) {
+                for (int i = 0; i <= tileCells; i++) {
+                    Vec2   pos = origin + Vec2(tx * tileCells + i, ty * tileCells + j) / res;
+                    double d   = std::numeric_limits<double>::infinity();
+                    for (std::uint32_t p: near[t]) d = std::min(d, polyDistance(pos, polys[p]));
+                    samples.push_back(static_cast<float>(d));
+                }
+            }
+        }
+    }
+
+    [[nodiscard]] Sample sample(const Vec2& pos) const {
+        constexpr Sample far{std::numeric_limits<double>::infinity(), Vec2()};
+        const double     fx = (pos.x - origin.x) * res;
+        const double     fy = (pos.y - origin.y) * res;
+        if (!(fx >= 0 && fy >= 0)) return far; // also nan
+        const double cx = std::floor(fx);
+        const double cy = std::floor(fy);
+        if (cx >= tilesX * tileCells || cy >= tilesY * tileCells) return far;
+        const int x  = static_cast<int>(cx);
+        const int y  = static_cast<int>(cy);
+        const int tx = x / tileCells;
+        const int ty = y / tileCells;
+        const int t  = tileIndex[static_cast<std::size_t>(tx + ty * tilesX)];
+        if (t < 0) return far;
+
+        const auto   base = static_cast<std::size_t>(t) * tileSamples +
+                          static_cast<std::size_t>((x - tx * tileCells) +
+                                                   (y - ty * tileCells) * (tileCells + 1));
+        const double d00  = samples[base];
+        const double d10  = samples[base + 1];
+        const double d01  = samples[base + tileCells + 1];
+        const double d11  = samples[base + tileCells + 2];
+        const double u    = fx - cx;
+        const double v    = fy - cy;
+        const double top  = d00 + (d10 - d00) * u;
+        const double bot  = d01 + (d11 - d01) * u;
+        return {top + (bot - top) * v,
+                Vec2((d10 - d00) * (1 - v) + (d11 - d01) * v, bot - top) * res};
+    }
+
+    // true if this was built from exactly these polygons, so doesn't need rebuilding
+    [[nodiscard]] bool bakedFrom(std::span<const Polygon> polys) const {
+        std::size_t i = 0;
+        for (const Polygon& poly: polys) {
+            for (const Vec2& p: poly.points) {
+                if (i >= baked.size() || !(baked[i++] == p)) return false;
+            }
+            if (i >= baked.size() || !std::isnan(baked[i++].x)) return false;
+        }
+        return i == baked.size();
+    }
+
+    [[nodiscard]] double      resolution() const { return res; }
+    [[nodiscard]] std::size_t polygonCount() const { return count; }
+    [[nodiscard]] std::size_t bytes() const {
+        return samples.size() * sizeof(float) + tileIndex.size() * sizeof(std::int32_t);
+    }
+
+  private:
+    static constexpr std::size_t tileSamples = (tileCells + 1) * (tileCells + 1);
+
+    double                    res    = 16;
+    Vec2                      origin = Vec2();
+    int                       tilesX = 0;
+    int                       tilesY = 0;
+    std::size_t               count  = 0;
+    std::vector<std::int32_t> tileIndex; // per tile, into samples in tileSamples. -1 if not stored
+    std::vector<float>        samples;
+    std::vector<Vec2>         baked; // every polygon's points, nan separated, for bakedFrom()
+};
+
+// the distance field counterpart of polyColHandler(): if pos is inside a polygon, moves it out
+// along the field's gradient by its depth and reflects vel about the surface
+inline void sdfColHandler(Vec2& pos, Vec2& vel, const DistanceField& sdf) {
+    DistanceField::Sample s = sdf.sample(pos);
+    if (!(s.dist < 0)) return;
+    double g = s.grad.mag();
+    if (g < 1e-10) return; // to prevent dividing by ~ 0, same as polyColHandler
+    Vec2 normal = s.grad / g;
+    pos -= normal * s.dist;
+    vel -= (2 * normal.dot(vel) * normal);
+}
+
+template <typename T>
+void sdfColHandler(Vector2<T>& pos, Vector2<T>& vel, const DistanceField& sdf) {
+    Vec2 p(pos);
+    Vec2 v(vel);
+    sdfColHandler(p, v, sdf);
+    if (p == Vec2(pos)) return;
+    pos = Vector2<T>(p);
+    vel = Vector2<T>(v);
+}
+
+// How far the field is from the exact geometry at a set of points, for judging a resolution.
+// Depth errors are over the points either one puts inside a polygon, as those are the only ones
+// collision acts on. wrongSide counts the points the two disagree on being inside at all.
+struct SdfError {
+    double      maxError  = 0;
+    double      meanError = 0;
+    std::size_t samples   = 0; // points inside by either, which the errors are over
+    std::size_t wrongSide = 0;
+};
+
+// points is any range of Vector2s, so a float body's positions can be passed straight in
+template <typename Points>
+SdfError measureSdfError(const DistanceField& sdf, std::span<const Polygon> polys,
+                         const PolygonGrid& grid, const Points& points) {
+    SdfError err;
+    double   sum = 0;
+    for (const auto& point: points) {
+        const Vec2 pos(point);
+        double     exact = std::numeric_limits<double>::infinity();
+        for (std::uint32_t p: grid.near(pos)) exact = std::min(exact, polyDistance(pos, polys[p]));
+        const double baked = sdf.sample(pos).dist;
+        if ((baked < 0) != (exact < 0)) ++err.wrongSide;
+        if (!(baked < 0 || exact < 0) || std::isinf(exact) || std::isinf(baked)) continue;
+        const double e = std::abs(baked - exact);
+        err.maxError   = std::max(err.maxError, e);
+        sum += e;
+        ++err.samples;
+    }
+    if (err.samples > 0) err.meanError = sum / static_cast<double>(err.samples);
+    return err;
+}
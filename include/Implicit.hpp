@@ -0,0 +1,190 @@
+#pragma once
+
+#include "Particles.hpp"
+#include "Spring.hpp"
+#include "ThreadPool.hpp"
+#include "Vector2.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+// symmetric 2x2 block, the unit of the implicit system
+template <typename T>
+struct BasicMat2 {
+    T xx = 0;
+    T xy = 0;
+    T yy = 0;
+
+    Vector2<T> operator*(const Vector2<T>& v) const {
+        return {xx * v.x + xy * v.y, xy * v.x + yy * v.y};
+    }
+
+    BasicMat2& operator+=(const BasicMat2& m) {
+        xx += m.xx;
+        xy += m.xy;
+        yy += m.yy;
+        return *this;
+    }
+
+    [[nodiscard]] BasicMat2 inverse() const {
+        T det = xx * yy - xy * xy;
+        return {yy / det, -xy / det, xx / det};
+    }
+};
+
+using Mat2 = BasicMat2<double>;
+
+// Backward (implicit) Euler, linearised once per step as in Baraff & Witkin:
+//
+//   (M - h D - h^2 K) dv = h (f + h K v)
+//
+// with K = df/dx and D = df/dv the spring Jacobians. Every spring couples just its two particles,
+// so the matrix has the grid's sparsity: one 2x2 block per spring plus a diagonal block per
+// particle. It is assembled as those blocks and multiplied without ever being expanded, and
+// solved by conjugate gradient preconditioned with the inverse diagonal blocks.
+//
+// The transverse part of K is dropped for compressed springs so the matrix stays positive
+// definite. That costs a little accuracy but keeps the step stable however stiff the springs
+// and however long the step, which is the point: one solve per visual frame rather than
+// thousands of explicit steps.
+template <typename T>
+class BasicImplicitSolver {
+    using Mat2 = BasicMat2<T>;
+    using Vec  = Vector2<T>;
+
+  public:
+    // relative residual at which cg stops. float can't resolve much below 1e-4
+    T   tolerance     = std::is_same_v<T, float> ? T(1e-4) : T(1e-6);
+    int maxIterations = 200;
+
+    int iterations = 0; // of the last solve
+    T   residual   = 0; // relative, of the last solve
+
+    // One step of dt. ps.f must already hold the spring forces at the current state (gravity is
+    // added here) and is cleared afterwards. springs/batchStarts as from colourSprings().
+    void step(BasicParticles<T>& ps, std::span<const BasicSpring<T>> springs,
+              std::span<const std::size_t> batchStarts, T dt, const Vec& g, ThreadPool* pool) {
+        const std::size_t n = ps.size();
+        assemble(ps, springs, dt);
+        rhs.assign(n, Vec());
+        parallelFor(pool, n, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; i++) rhs[i] = (ps.f[i] + g * ps.mass(i)) * dt;
+        });
+        for (std::size_t s = 0; s < springs.size(); s++) { // + h^2 K v
+            Vec d = stiff[s] * (ps.vel[springs[s].a] - ps.vel[springs[s].b]) * (dt * dt);
+            rhs[springs[s].a] -= d;
+            rhs[springs[s].b] += d;
+        }
+
+        solve(ps, springs, batchStarts, pool);
+
+        parallelFor(pool, n, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; i++) {
+                ps.vel[i] += dv[i];
+                ps.pos[i] += ps.vel[i] * dt;
+                ps.f[i] = Vec();
+            }
+        });
+    }
+
+  private:
+    std::vector<Mat2> stiff;   // per spring: -dF/dx, so K is made of -stiff blocks
+    std::vector<Mat2> blocks;  // per spring: off diagonal block of A, negated
+    std::vector<Mat2> diagInv; // per particle: inverse of A's diagonal block
+    std::vector<Vec>  rhs;
+    std::vector<Vec>  dv;
+    std::vector<Vec>  r;
+    std::vector<Vec>  z;
+    std::vector<Vec>  p;
+    std::vector<Vec>  ap;
+
+    void assemble(const BasicParticles<T>& ps, std::span<const BasicSpring<T>> springs, T h) {
+        stiff.resize(springs.size());
+        blocks.resize(springs.size());
+        diagInv.assign(ps.size(), Mat2());
+        for (std::size_t i = 0; i < ps.size(); i++) diagInv[i].xx = diagInv[i].yy = ps.mass(i);
+
+        for (std::size_t s = 0; s < springs.size(); s++) {
+            const BasicSpring<T>& sp  = springs[s];
+            Vec                   d   = ps.pos[sp.a] - ps.pos[sp.b];
+            T                     len = d.mag();
+            Vec                   u   = d / len;
+            // k (u u^T + (1 - rest / len) (I - u u^T)), without the transverse part when the
+            // spring is compressed
+            T    t = std::max(T(0), 1 - sp.rest / len);
+            Mat2 uu{u.x * u.x, u.x * u.y, u.y * u.y};
+            Mat2 k{sp.k * (t + (1 - t) * uu.xx), sp.k * (1 - t) * uu.xy,
+                   sp.k * (t + (1 - t) * uu.yy)};
+            stiff[s]  = k;
+            blocks[s] = {h * (sp.damp * uu.xx + h * k.xx), h * (sp.damp * uu.xy + h * k.xy),
+                         h * (sp.damp * uu.yy + h * k.yy)};
+            diagInv[sp.a] += blocks[s];
+            diagInv[sp.b] += blocks[s];
+        }
+        for (Mat2& m: diagInv) m = m.inverse();
+    }
+
+    // out = A x. Batches of one colour share no particle, so each is spread across the pool
+    void multiply(const BasicParticles<T>& ps, std::span<const BasicSpring<T>> springs,
+                  std::span<const std::size_t> batchStarts, const std::vector<Vec>& x,
+                  std::vector<Vec>& out, ThreadPool* pool) {
+        parallelFor(pool, ps.size(), [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; i++) out[i] = x[i] * ps.mass(i);
+        });
+        for (std::size_t c = 0; c + 1 < batchStarts.size(); c++) {
+            const std::size_t first = batchStarts[c];
+            parallelFor(pool, batchStarts[c + 1] - first, [&](std::size_t begin, std::size_t end) {
+                for (std::size_t s = first + begin; s < first + end; s++) {
+                    Vec d = blocks[s] * (x[springs[s].a] - x[springs[s].b]);
+                    out[springs[s].a] += d;
+                    out[springs[s].b] -= d;
+                }
+            });
+        }
+    }
+
+    // summed in double whatever T, or a float solve stalls well short of its tolerance
+    static double dot(const std::vector<Vec>& a, const std::vector<Vec>& b) {
+        double sum = 0;
+        for (std::size_t i = 0; i < a.size(); i++) sum += a[i].dot(b[i]);
+        return sum;
+    }
+
+    void solve(const BasicParticles<T>& ps, std::span<const BasicSpring<T>> springs,
+               std::span<const std::size_t> batchStarts, ThreadPool* pool) {
+        const std::size_t n = ps.size();
+        dv.assign(n, Vec());
+        r = rhs; // residual of dv = 0
+        z.resize(n);
+        ap.resize(n);
+        for (std::size_t i = 0; i < n; i++) z[i] = diagInv[i] * r[i];
+        p = z;
+
+        const double bb = dot(rhs, rhs);
+        double       rz = dot(r, z);
+        iterations      = 0;
+        residual        = 0;
+        if (bb == 0) return;
+        while (iterations < maxIterations) {
+            residual = static_cast<T>(std::sqrt(dot(r, r) / bb));
+            if (residual <= tolerance) break;
+            multiply(ps, springs, batchStarts, p, ap, pool);
+            const auto alpha = static_cast<T>(rz / dot(p, ap));
+            for (std::size_t i = 0; i < n; i++) {
+                dv[i] += alpha * p[i];
+                r[i] -= alpha * ap[i];
+                z[i] = diagInv[i] * r[i];
+            }
+            const double rzNext = dot(r, z);
+            const auto   beta   = static_cast<T>(rzNext / rz);
+            rz                  = rzNext;
+            for (std::size_t i = 0; i < n; i++) p[i] = z[i] + beta * p[i];
+            ++iterations;
+        }
+    }
+};
+
+using ImplicitSolver = BasicImplicitSolver<double>;
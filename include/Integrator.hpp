@@ -0,0 +1,85 @@
+#pragma once
+
+#include "Particles.hpp"
+#include "ThreadPool.hpp"
+#include "Vector2.hpp"
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+// Time integration schemes, selectable per body. Each step takes a `forces` callable which
+// accumulates every internal force into ps.f (starting from zero), and leaves ps.f cleared.
+// implicitEuler needs the springs themselves rather than just their forces: see Implicit.hpp.
+// xpbd replaces forces altogether with constraints, collisions included: see Xpbd.hpp
+enum class Integrator { symplecticEuler, verlet, rk4, implicitEuler, xpbd };
+
+inline constexpr const char* integratorNames[] = {"Symplectic Euler", "Position Verlet", "RK4",
+                                                  "Implicit Euler", "XPBD"};
+
+// buffers for the multi-stage schemes, kept between steps so stepping doesn't allocate
+template <typename T>
+struct BasicIntegratorScratch {
+    std::vector<Vector2<T>> pos0;
+    std::vector<Vector2<T>> vel0;
+    std::vector<Vector2<T>> dx;
+    std::vector<Vector2<T>> dv;
+};
+
+using IntegratorScratch = BasicIntegratorScratch<double>;
+
+// Position (drift-kick-drift) Verlet: half a step of drift, one force evaluation at the midpoint,
+// a full kick, then the other half drift. Symplectic and second order, for the same single force
+// evaluation per step as Euler.
+template <typename T, typename Forces>
+void verletStep(BasicParticles<T>& ps, std::type_identity_t<T> dt, const Vector2<T>& g,
+                ThreadPool* pool, Forces&& forces) {
+    const T h = dt / 2;
+    parallelFor(pool, ps.size(), [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; i++) ps.pos[i] += ps.vel[i] * h;
+    });
+    forces();
+    parallelFor(pool, ps.size(), [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; i++) {
+            ps.vel[i] += (ps.f[i] * ps.invMass[i] + g) * dt;
+            ps.pos[i] += ps.vel[i] * h;
+            ps.f[i] = Vector2<T>();
+        }
+    });
+}
+
+// Classic 4th order Runge-Kutta on (pos, vel). Four force evaluations per step, and not
+// symplectic, so it slowly loses energy, but it is very accurate per step.
+template <typename T, typename Forces>
+void rk4Step(BasicParticles<T>& ps, std::type_identity_t<T> dt, const Vector2<T>& g,
+             ThreadPool* pool, BasicIntegratorScratch<T>& s, Forces&& forces) {
+    const std::size_t n = ps.size();
+    s.pos0.assign(ps.pos.begin(), ps.pos.end());
+    s.vel0.assign(ps.vel.begin(), ps.vel.end());
+    s.dx.assign(n, Vector2<T>());
+    s.dv.assign(n, Vector2<T>());
+
+    constexpr T weight[4] = {1, 2, 2, 1};
+    constexpr T next[4]   = {0.5, 0.5, 1, 0}; // where the following stage is evaluated
+    for (int k = 0; k < 4; k++) {
+        forces(); // at the current stage's pos and vel
+        const T w = weight[k];
+        const T c = next[k] * dt;
+        parallelFor(pool, n, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; i++) {
+                const Vector2<T> kx = ps.vel[i];
+                const Vector2<T> kv = ps.f[i] * ps.invMass[i] + g;
+                s.dx[i] += w * kx;
+                s.dv[i] += w * kv;
+                ps.pos[i] = s.pos0[i] + c * kx;
+                ps.vel[i] = s.vel0[i] + c * kv;
+                ps.f[i]   = Vector2<T>();
+            }
+        });
+    }
+    parallelFor(pool, n, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; i++) {
+            ps.pos[i] = s.pos0[i] + s.dx[i] * (dt / 6);
+            ps.vel[i] = s.vel0[i] + s.dv[i] * (dt / 6);
+        }
+    });
+}
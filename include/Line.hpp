@@ -1,20 +1,33 @@
 #pragma once
 
 #include "Vector2.hpp"
-#include <vector>
+#include <ostream>
 
+// A line segment with the values every distance query needs worked out once, up front
 template <typename Number>
 struct Line {
-    const Vector2<Number> start;
-    const Vector2<Number> end;
-    const double          len;  // used for performance caching (sqrt is expensive)
-    const Vector2<Number> norm; // more performance caching
+    Vector2<Number> start;
+    Vector2<Number> end;
+    double          len;    // used for performance caching (sqrt is expensive)
+    double          invLen; // and division isn't much better. 0 for a zero length line
+    Vector2<Number> norm;   // unit direction, start to end
+    Vector2<Number> normal; // unit normal, norm turned a quarter: (-norm.y, norm.x)
 
     Line(const Vector2<Number>& start_, const Vector2<Number>& end_) // NOLINT similar params
-        : start(start_), end(end_), len((end - start).mag()), norm((end - start) / len) {}
+        : start(start_), end(end_), len((end - start).mag()), invLen(len > 0 ? 1 / len : 0),
+          norm((end - start) * invLen), normal(-norm.y, norm.x) {}
+
+    // signed distance of pos from the infinite line, positive on the side normal points to
+    double side(const Vector2<Number>& pos) const { return (pos - start).dot(normal); }
+
+    // the point on the segment closest to pos
+    Vector2<Number> closest(const Vector2<Number>& pos) const {
+        double t = (pos - start).dot(norm) * invLen; // 0 at start, 1 at end
+        t        = t < 0 ? 0 : (t > 1 ? 1 : t);
+        return start + (end - start) * t;
+    }
 
     friend std::ostream& operator<<(std::ostream& os, const Line& l) {
         return os << l.start << " => " << l.end << " (" << l.len << ")";
     }
 };
-
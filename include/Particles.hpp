@@ -0,0 +1,78 @@
+#pragma once
+
+#include "Vector2.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+// reserve(), but at least doubling the capacity when it grows, so growing v a little at a time
+// reallocates only a handful of times rather than at every step
+template <typename V>
+void reserveGrowing(V& v, std::size_t n) {
+    if (v.capacity() < n) v.reserve(std::max(n, 2 * v.capacity()));
+}
+
+// Structure of arrays particle store. Each attribute the simulation touches lives in its own
+// contiguous array, indexed by particle number, so the spring and integration passes only stream
+// the bytes they actually use. Nothing render related belongs in here.
+//
+// T is the precision everything is stored and simulated in: double for reference runs, float
+// for half the memory traffic and twice the vector width.
+template <typename T>
+struct BasicParticles {
+    std::vector<Vector2<T>> pos;
+    std::vector<Vector2<T>> vel;
+    std::vector<Vector2<T>> f;
+    std::vector<T>          invMass; // stored inverted: integration divides by mass on every step
+    std::vector<T>          radius;
+
+    [[nodiscard]] std::size_t size() const { return pos.size(); }
+    [[nodiscard]] bool        empty() const { return pos.empty(); }
+
+    T mass(std::size_t i) const { return 1 / invMass[i]; }
+
+    std::size_t add(const Vector2<T>& pos_, T mass_, T radius_) {
+        pos.push_back(pos_);
+        vel.emplace_back(0, 0);
+        f.emplace_back(0, 0);
+        invMass.push_back(1 / mass_);
+        radius.push_back(radius_);
+        return pos.size() - 1;
+    }
+
+    void reserve(std::size_t n) {
+        pos.reserve(n);
+        vel.reserve(n);
+        f.reserve(n);
+        invMass.reserve(n);
+        radius.reserve(n);
+    }
+
+    // reserve(), growing geometrically
+    void reserveGrowing(std::size_t n) {
+        ::reserveGrowing(pos, n);
+        ::reserveGrowing(vel, n);
+        ::reserveGrowing(f, n);
+        ::reserveGrowing(invMass, n);
+        ::reserveGrowing(radius, n);
+    }
+
+    void resize(std::size_t n) {
+        pos.resize(n);
+        vel.resize(n);
+        f.resize(n);
+        invMass.resize(n);
+        radius.resize(n);
+    }
+
+    void clear() {
+        pos.clear();
+        vel.clear();
+        f.clear();
+        invMass.clear();
+        radius.clear();
+    }
+};
+
+using Particles  = BasicParticles<double>;
+using ParticlesF = BasicParticles<float>;
@@ -1,14 +1,14 @@
 #pragma once
 
-#include <SFML/Graphics.hpp>
+#include "Line.hpp"
 #include <Vector2.hpp>
-
-sf::Vector2f visualize(const Vec2& v);
+#include <algorithm>
+#include <cstddef>
+#include <vector>
 
 class Polygon {
   private:
-    sf::ConvexShape shape;
-    void            boundsUp() {
+    void boundsUp() {
         maxBounds = points[0];
         minBounds = points[0];
         for (std::size_t x = 1; x < points.size(); x++) {
@@ -19,16 +19,31 @@ class Polygon {
         }
     }
 
+    void edgesUp() {
+        edges.clear();
+        edges.reserve(points.size());
+        for (std::size_t x = 0; x < points.size(); x++)
+            edges.emplace_back(points[x], points[(x + 1) % points.size()]);
+    }
+
   public:
-    std::vector<Vec2> points;
-    Vec2              maxBounds;
-    Vec2              minBounds;
-    std::size_t       pointCount;
+    std::vector<Vec2>         points;
+    std::vector<Line<double>> edges; // edges[x] runs points[x] => points[x + 1], wrapping round
+    Vec2                      maxBounds;
+    Vec2                      minBounds;
+    std::size_t               pointCount;
     explicit Polygon(std::vector<Vec2> points_)
         : points(std::move(points_)), pointCount(points.size()) {
-        shape.setPointCount(pointCount);
         boundsUp();
-        for (std::size_t x = 0; x < points.size(); x++) shape.setPoint(x, visualize(points[x]));
+        edgesUp();
+    }
+
+    // re-derives the bounds and edges after `points` has been changed in place, which re-uses
+    // their allocations. points mustn't be empty
+    void pointsChanged() {
+        pointCount = points.size();
+        boundsUp();
+        edgesUp();
     }
 
     bool isBounded(Vec2 pos) const {
@@ -36,11 +51,6 @@ class Polygon {
                pos.y <= maxBounds.y;
     }
 
-    void draw(sf::RenderWindow& window) {
-        for (std::size_t x = 0; x < points.size(); x++) shape.setPoint(x, visualize(points[x]));
-        window.draw(shape);
-    }
-
     // static stuff
     static Polygon Square(Vec2 pos, double tilt) {
         return Polygon({Vec2(4, 0.5) + pos, Vec2(-4, 0.5) + pos, Vec2(-4, -0.5 + tilt) + pos,
@@ -50,4 +60,4 @@ class Polygon {
     static Polygon Triangle(Vec2 pos) {
         return Polygon({Vec2(1, 1) + pos, Vec2(-1, 1) + pos, Vec2(0, -1) + pos});
     }
-};
\ No newline at end of file
+};
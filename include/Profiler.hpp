@@ -0,0 +1,155 @@
+#pragma once
+
+#include "Trace.hpp"
+#include "damper.hpp"
+#include "median.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Scoped timers around the phases of a simulation step and of a rendered frame, and rolling
+// statistics of each. A timer records into whichever Profiler its thread has installed with
+// InstallProfiler, so the physics can be timed without knowing who is looking. Each phase is also
+// an event on the timeline of an active Tracer (see Trace.hpp). With no profiler installed and no
+// tracer active, a timer costs two loads and a test. Built without SOFTBODY_PROFILE (the cmake
+// option of the same name), SOFTBODY_TIME() expands to nothing at all.
+
+enum class Phase : std::uint8_t {
+    step,        // a whole SimState::step, everything below and the rest
+    springs,
+    broadphase,  // the cell list for contacts between points
+    narrowphase, // the contact forces between the pairs it finds
+    integrate,   // with verlet and rk4, which evaluate forces as they go, including those, and
+                 // with xpbd its whole solve, collisions and all
+    polygons,    // finding the polygons near each point and pushing it out of them
+    frame,       // a whole rendered frame, everything below and the rest
+    imgui,       // building the panels
+    render,      // drawing the body, polygons and panels
+    display,     // window.display(), which may wait for vsync
+    count
+};
+
+inline constexpr std::size_t phaseCount = static_cast<std::size_t>(Phase::count);
+
+inline constexpr std::array<const char*, phaseCount> phaseNames = {
+    "Step",      "Springs", "Broadphase", "Narrowphase", "Integrate",
+    "Polygons",  "Frame",   "ImGui",      "Render",      "Display"};
+
+// of one phase over a Profiler's window, in microseconds per call. avg is smoothed by a damper
+// with the window as its time constant, the rest are exact
+struct PhaseStats {
+    std::size_t samples = 0; // 0 if the phase hasn't run
+    double      min     = 0;
+    double      avg     = 0;
+    double      max     = 0;
+    double      p50     = 0;
+    double      p99     = 0;
+};
+
+class Profiler {
+  public:
+    static constexpr std::size_t window = 1024; // most recent samples per phase
+
+    void add(Phase phase, std::chrono::steady_clock::duration time) {
+        Samples&    s  = phases[static_cast<std::size_t>(phase)];
+        const float us = std::chrono::duration<float, std::micro>(time).count();
+        s.us[s.next]   = us;
+        s.next         = (s.next + 1) % window;
+        s.count        = std::min(s.count + 1, window);
+        s.avg(us);
+    }
+
+    // Sorts a copy of the window, so call it at display rate rather than per sample
+    PhaseStats stats(Phase phase) {
+        const Samples& s = phases[static_cast<std::size_t>(phase)];
+        PhaseStats     out;
+        out.samples = s.count;
+        if (s.count == 0) return out;
+        sorted.assign(s.us.begin(), s.us.begin() + static_cast<std::ptrdiff_t>(s.count));
+        const auto [lo, hi] = std::ranges::minmax(sorted);
+        out.min             = lo;
+        out.max             = hi;
+        out.avg             = s.avg.current();
+        out.p50             = median_in_place(sorted);
+        const auto nth      = static_cast<std::ptrdiff_t>(
+            std::ceil(0.99 * static_cast<double>(s.count)) - 1);
+        std::ranges::nth_element(sorted, sorted.begin() + nth);
+        out.p99 = sorted[static_cast<std::size_t>(nth)];
+        return out;
+    }
+
+    // the profiler this thread's timers record into, nullptr if none
+    static Profiler* current() { return installed; }
+
+  private:
+    struct Samples {
+        std::array<float, window> us{}; // a ring, the oldest at next once full
+        std::size_t               next  = 0;
+        std::size_t               count = 0;
+        damper<float>             avg{static_cast<short>(window)};
+    };
+
+    std::array<Samples, phaseCount> phases;
+    std::vector<float>              sorted; // kept so stats() doesn't allocate
+
+    static inline thread_local Profiler* installed = nullptr;
+
+    friend class InstallProfiler;
+};
+
+// Makes profiler the one this thread's timers record into while it is in scope
+class InstallProfiler {
+  public:
+    explicit InstallProfiler(Profiler& profiler) : previous(Profiler::installed) {
+        Profiler::installed = &profiler;
+    }
+
+    InstallProfiler(const InstallProfiler&) = delete;
+    InstallProfiler& operator=(const InstallProfiler&) = delete;
+
+    ~InstallProfiler() { Profiler::installed = previous; }
+
+  private:
+    Profiler* previous;
+};
+
+// Times from construction to the end of its scope, into the thread's profiler if it has one, and
+// as an event of the active tracer if there is one. Use through SOFTBODY_TIME(), which compiles
+// out
+class ScopedTimer {
+  public:
+    explicit ScopedTimer(Phase phase_)
+        : profiler(Profiler::current()), tracer(Tracer::current()), phase(phase_) {
+        if (profiler != nullptr || tracer != nullptr) start = std::chrono::steady_clock::now();
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    ~ScopedTimer() {
+        if (profiler == nullptr && tracer == nullptr) return;
+        const auto end = std::chrono::steady_clock::now();
+        if (profiler != nullptr) profiler->add(phase, end - start);
+        if (tracer != nullptr)
+            tracer->record(phaseNames[static_cast<std::size_t>(phase)], start, end);
+    }
+
+  private:
+    Profiler*                             profiler;
+    Tracer*                               tracer;
+    Phase                                 phase;
+    std::chrono::steady_clock::time_point start;
+};
+
+// times the rest of the enclosing scope as phase
+#ifdef SOFTBODY_PROFILE
+#define SOFTBODY_TIME_NAME2(line) scopedTimer##line
+#define SOFTBODY_TIME_NAME(line)  SOFTBODY_TIME_NAME2(line)
+#define SOFTBODY_TIME(phase)      const ScopedTimer SOFTBODY_TIME_NAME(__LINE__)(phase)
+#else
+#define SOFTBODY_TIME(phase) static_cast<void>(0)
+#endif
@@ -0,0 +1,313 @@
+#include "Recording.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// how long the writer sleeps when it has caught up. A chunk takes far longer than this to fill
+constexpr std::chrono::milliseconds writerIdle{1};
+
+std::uint32_t zigzag(std::int32_t v) {
+    return (static_cast<std::uint32_t>(v) << 1U) ^ static_cast<std::uint32_t>(v >> 31);
+}
+
+std::int32_t unzigzag(std::uint32_t v) {
+    return static_cast<std::int32_t>(v >> 1U) ^ -static_cast<std::int32_t>(v & 1U);
+}
+
+// at out, which must have room for 5 bytes, and returns just past what it wrote
+std::byte* putVarint(std::byte* out, std::uint32_t v) {
+    while (v >= 0x80) {
+        *out++ = static_cast<std::byte>((v & 0x7FU) | 0x80U);
+        v >>= 7U;
+    }
+    *out++ = static_cast<std::byte>(v);
+    return out;
+}
+
+// from in at `at`, which it moves past. Throws std::runtime_error if it runs off the end
+std::uint32_t getVarint(std::span<const std::byte> in, std::size_t& at) {
+    std::uint32_t v = 0;
+    for (unsigned shift = 0; shift < 32; shift += 7) {
+        if (at == in.size()) break;
+        const auto b = static_cast<std::uint32_t>(in[at++]);
+        v |= (b & 0x7FU) << shift;
+        if ((b & 0x80U) == 0) return v;
+    }
+    throw std::runtime_error("recording: corrupt chunk");
+}
+
+// Out of range (or NaN) positions are clamped rather than left to overflow. Takes the reciprocal
+// of the quantum, and rounds half away from zero without a library call, as this is most of what
+// the writer does
+std::int32_t quantise(float v, double perQuantum) {
+    constexpr double lo = std::numeric_limits<std::int32_t>::min();
+    constexpr double hi = std::numeric_limits<std::int32_t>::max();
+    double           q  = static_cast<double>(v) * perQuantum;
+    if (!(q > lo && q < hi)) q = q >= hi ? hi : q <= lo ? lo : 0; // NaN fails both
+    return static_cast<std::int32_t>(q < 0 ? q - 0.5 : q + 0.5);
+}
+
+// wrapping, so any two int32s have a delta which gets back from one to the other
+std::int32_t minus(std::int32_t a, std::int32_t b) {
+    return static_cast<std::int32_t>(static_cast<std::uint32_t>(a) -
+                                     static_cast<std::uint32_t>(b));
+}
+
+std::int32_t plus(std::int32_t a, std::int32_t b) {
+    return static_cast<std::int32_t>(static_cast<std::uint32_t>(a) +
+                                     static_cast<std::uint32_t>(b));
+}
+
+// Quantised delta encoding of frames x points positions, see Recording.hpp. Coordinates are
+// interleaved, x then y, so "the point before" is two coordinates back. prev is scratch
+void encode(std::span<const Vec2F> pos, std::size_t points, double quantum,
+            std::vector<std::int32_t>& prev, std::vector<std::byte>& out) {
+    prev.assign(2 * points, 0);
+    out.resize(pos.size() * 2 * 5); // the most varints can take
+    std::byte*   at         = out.data();
+    const double perQuantum = 1 / quantum;
+    for (std::size_t frame = 0; frame < pos.size(); frame += points) {
+        const bool first = frame == 0;
+        for (std::size_t j = 0; j < 2 * points; j++) {
+            const Vec2F&       p    = pos[frame + j / 2];
+            const std::int32_t q    = quantise(j % 2 == 0 ? p.x : p.y, perQuantum);
+            const std::int32_t base = first ? (j < 2 ? 0 : prev[j - 2]) : prev[j];
+            at                      = putVarint(at, zigzag(minus(q, base)));
+            prev[j]                 = q;
+        }
+    }
+    out.resize(static_cast<std::size_t>(at - out.data()));
+}
+
+} // namespace
+
+void Recorder::open(const std::string& path, double dt, std::span<const float> radius,
+                    std::span<const SpringF> springs, const std::vector<Polygon>& polys) {
+    if (options.stride < 1 || options.framesPerChunk < 1 || options.quantum < 0)
+        throw std::invalid_argument("recorder: bad options");
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file) throw std::runtime_error("recording: could not write " + path);
+
+    std::vector<std::byte> header;
+    CheckpointWriter       out(header, recordingMagic, recordingVersion);
+    out.put(static_cast<std::uint64_t>(pointCount));
+    out.put(options.stride);
+    out.put(options.framesPerChunk);
+    out.put(dt);
+    out.put(options.quantum);
+    out.putArray(radius);
+    out.putArray(springs);
+    out.put(static_cast<std::uint64_t>(polys.size()));
+    for (const Polygon& poly: polys) out.putArray(std::span(poly.points));
+    out.finish();
+    file.write(reinterpret_cast<const char*>(header.data()), // NOLINT byte access
+               static_cast<std::streamsize>(header.size()));
+    if (!file) throw std::runtime_error("recording: could not write " + path);
+    written = header.size();
+
+    chunk.pos.reserve(pointCount * static_cast<std::size_t>(options.framesPerChunk));
+    writer = std::jthread([this](const std::stop_token& stop) { write(stop); });
+}
+
+Recorder::~Recorder() {
+    if (chunk.frames > 0) flush();
+    writer.request_stop();
+    writer.join();
+}
+
+void Recorder::flush() {
+    // the writer is behind: sleep until it takes a chunk rather than spin the recording thread
+    std::uint64_t seen = taken.load(std::memory_order_acquire);
+    while (!full.push(std::move(chunk))) {
+        taken.wait(seen, std::memory_order_acquire);
+        seen = taken.load(std::memory_order_acquire);
+    }
+    if (!empty.pop(chunk)) chunk = {};
+    chunk.frames = 0;
+    chunk.pos.clear();
+    chunk.pos.reserve(pointCount * static_cast<std::size_t>(options.framesPerChunk));
+}
+
+void Recorder::write(const std::stop_token& stop) {
+    Chunk                     next;
+    std::vector<std::byte>    bytes;
+    std::vector<std::int32_t> prev;
+    while (true) {
+        // read before popping, so a chunk pushed just before the stop is still written
+        const bool stopping = stop.stop_requested();
+        if (!full.pop(next)) {
+            if (stopping) break;
+            std::this_thread::sleep_for(writerIdle);
+            continue;
+        }
+        taken.fetch_add(1, std::memory_order_release);
+        taken.notify_one(); // flush() may be waiting for the room
+
+        bytes.clear();
+        if (options.quantum > 0) {
+            encode(next.pos, pointCount, options.quantum, prev, bytes);
+        } else {
+            const auto raw = std::as_bytes(std::span(next.pos));
+            bytes.assign(raw.begin(), raw.end());
+        }
+        RecordingChunk header;
+        header.frames    = next.frames;
+        header.firstStep = next.firstStep;
+        header.bytes     = bytes.size();
+        file.write(reinterpret_cast<const char*>(&header), sizeof header); // NOLINT byte access
+        file.write(reinterpret_cast<const char*>(bytes.data()),            // NOLINT byte access
+                   static_cast<std::streamsize>(bytes.size()));
+        file.flush(); // so a replay opened meanwhile sees whole chunks
+        if (!file) writeFailed = true;
+        written.fetch_add(sizeof header + bytes.size(), std::memory_order_relaxed);
+
+        next.pos.clear();
+        empty.push(std::move(next)); // if that is full too, the buffer is just freed
+    }
+}
+
+#ifdef _WIN32
+MappedFile::MappedFile(const std::string& path) {
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                              nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) throw std::runtime_error("could not open " + path);
+    LARGE_INTEGER length;
+    HANDLE        mapping = nullptr;
+    if (GetFileSizeEx(file, &length) != 0 && length.QuadPart > 0)
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file); // the mapping keeps it open
+    if (mapping == nullptr) throw std::runtime_error("could not map " + path);
+    data = static_cast<const std::byte*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    CloseHandle(mapping); // and the view keeps the mapping
+    if (data == nullptr) throw std::runtime_error("could not map " + path);
+    size = static_cast<std::size_t>(length.QuadPart);
+}
+
+MappedFile::~MappedFile() { UnmapViewOfFile(data); }
+#else
+MappedFile::MappedFile(const std::string& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY); // NOLINT vararg
+    if (fd < 0) throw std::runtime_error("could not open " + path);
+    struct stat info {};
+    void*       mapped = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        size   = static_cast<std::size_t>(info.st_size);
+        mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    ::close(fd); // the mapping keeps the file open
+    if (mapped == MAP_FAILED) throw std::runtime_error("could not map " + path);
+    data = static_cast<const std::byte*>(mapped);
+}
+
+MappedFile::~MappedFile() {
+    munmap(const_cast<std::byte*>(data), size); // NOLINT munmap wants it non const
+}
+#endif
+
+Replay::Replay(const std::string& path) : map(path) {
+    const std::span<const std::byte> file       = map.bytes();
+    const std::size_t                headerSize = checkpointSize(file);
+    if (headerSize == 0) throw std::runtime_error("recording: not a recording");
+    CheckpointReader in(file.first(headerSize), recordingMagic, recordingVersion);
+    pointCount  = static_cast<std::size_t>(in.get<std::uint64_t>());
+    frameStride = in.get<int>();
+    chunkFrames = in.get<int>();
+    stepDt      = in.get<double>();
+    quantum     = in.get<double>();
+    in.getArray(radii);
+    std::vector<SpringF> springs;
+    in.getArray(springs);
+    for (const SpringF& s: springs) springList.push_back({s.a, s.b, s.rest, s.k, s.damp});
+    const auto polyCount = in.get<std::uint64_t>();
+    if (polyCount > headerSize) throw std::runtime_error("recording: corrupt header");
+    std::vector<Vec2> points;
+    for (std::uint64_t p = 0; p < polyCount; p++) {
+        in.getArray(points);
+        if (points.empty()) throw std::runtime_error("recording: corrupt header");
+        polys.emplace_back(points);
+    }
+    if (radii.size() != pointCount || frameStride < 1 || chunkFrames < 1 || quantum < 0)
+        throw std::runtime_error("recording: corrupt header");
+    for (const Spring& s: springList) {
+        if (s.a >= pointCount || s.b >= pointCount)
+            throw std::runtime_error("recording: corrupt header");
+    }
+
+    // index every whole chunk, up to the first which isn't
+    const std::size_t rawBytes = pointCount * sizeof(Vec2F);
+    std::size_t       at       = headerSize;
+    while (file.size() - at >= sizeof(RecordingChunk)) {
+        RecordingChunk chunk;
+        std::memcpy(&chunk, file.data() + at, sizeof chunk);
+        at += sizeof chunk;
+        if (chunk.magic != RecordingChunk{}.magic || chunk.frames == 0 ||
+            chunk.frames > static_cast<std::uint32_t>(chunkFrames) ||
+            chunk.bytes > file.size() - at ||
+            (quantum == 0 && chunk.bytes != chunk.frames * rawBytes))
+            break;
+        chunks.push_back({at, static_cast<std::size_t>(chunk.bytes), frameCount, chunk.frames,
+                          chunk.firstStep});
+        frameCount += chunk.frames;
+        at += static_cast<std::size_t>(chunk.bytes);
+    }
+    decodedChunk = chunks.size();
+    quantised.resize(2 * pointCount);
+}
+
+std::uint64_t Replay::step(std::size_t frame) const {
+    if (frame >= frameCount) throw std::out_of_range("replay: no such frame");
+    auto c = std::ranges::upper_bound(chunks, frame, {}, &ChunkIndex::firstFrame) - 1;
+    return c->firstStep + (frame - c->firstFrame) * static_cast<std::uint64_t>(frameStride);
+}
+
+void Replay::frame(std::size_t index, std::vector<Vec2>& out) {
+    if (index >= frameCount) throw std::out_of_range("replay: no such frame");
+    const auto c = static_cast<std::size_t>(
+        std::ranges::upper_bound(chunks, index, {}, &ChunkIndex::firstFrame) - chunks.begin() - 1);
+    const ChunkIndex&                chunk = chunks[c];
+    const std::size_t                k     = index - chunk.firstFrame;
+    const std::span<const std::byte> bytes = map.bytes().subspan(chunk.offset, chunk.bytes);
+    out.resize(pointCount);
+
+    if (quantum == 0) {
+        const std::size_t frameBytes = pointCount * sizeof(Vec2F);
+        for (std::size_t i = 0; i < pointCount; i++) {
+            Vec2F p;
+            std::memcpy(&p, bytes.data() + k * frameBytes + i * sizeof p, sizeof p);
+            out[i] = Vec2(p);
+        }
+        return;
+    }
+
+    if (c != decodedChunk || k < nextFrame) {
+        decodedChunk = c;
+        nextFrame    = 0;
+        cursor       = 0;
+    }
+    for (; nextFrame <= k; nextFrame++) {
+        const bool first = nextFrame == 0;
+        for (std::size_t j = 0; j < 2 * pointCount; j++) {
+            const std::int32_t base = first ? (j < 2 ? 0 : quantised[j - 2]) : quantised[j];
+            quantised[j]            = plus(base, unzigzag(getVarint(bytes, cursor)));
+        }
+    }
+    for (std::size_t i = 0; i < pointCount; i++) {
+        out[i] = Vec2(quantised[2 * i] * quantum, quantised[2 * i + 1] * quantum);
+    }
+}
@@ -0,0 +1,192 @@
+#pragma once
+
+#include "Checkpoint.hpp"
+#include "Polygon.hpp"
+#include "SoftBody.hpp"
+#include "SpscQueue.hpp"
+#include "Spring.hpp"
+#include "Vector2.hpp"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Trajectory recordings: a body's positions every `stride` steps, streamed to a file for looking
+// at offline. The file is
+//
+//   header   a checkpoint style block (see Checkpoint.hpp) with its own magic and version,
+//            holding the point count, stride, dt, quantum, frames per chunk, and the radii,
+//            springs and polygons, which don't change during a recording
+//   chunks   one after another to the end of the file, each a RecordingChunk then its frames
+//
+// Every chunk decodes on its own, so playback can start anywhere, and a file cut short by a crash
+// is still readable up to its last whole chunk. Frames are float positions as they are, or with a
+// quantum, rounded to multiples of it and delta encoded: the first frame of a chunk from point to
+// point and every later one from the frame before, as zigzag varints. A body moves little between
+// frames, so most coordinates fit in a byte or two instead of four.
+
+inline constexpr std::array<char, 4> recordingMagic{'S', 'B', 'R', 'C'};
+inline constexpr std::uint32_t       recordingVersion = 2;
+
+struct RecordingChunk {
+    std::array<char, 4> magic{'C', 'H', 'N', 'K'};
+    std::uint32_t       frames    = 0;
+    std::uint64_t       firstStep = 0; // SimState::steps of the first frame
+    std::uint64_t       bytes     = 0; // of encoded frames after this
+};
+
+struct RecordOptions {
+    int    stride         = 1;  // a frame every this many steps
+    double quantum        = 0;  // rounding of positions, 0 to store them as they are
+    int    framesPerChunk = 64; // the most frames playback decodes to reach any one
+};
+
+// Streams frames to a file from a background thread. record() only copies the positions into the
+// current chunk; full chunks go to the writer thread through a lock-free queue, which encodes and
+// writes them, then hands the buffers back to be re-used. If the writer falls behind, record()
+// blocks until it takes a chunk rather than drop frames. Everything but the writer runs on the
+// recording thread.
+class Recorder {
+  public:
+    // Creates or overwrites path and writes the header there, then records frames of the body
+    // from the next step on. Throws std::runtime_error if the file can't be written, and
+    // std::invalid_argument on bad options
+    template <typename T>
+    Recorder(const std::string& path, const BasicSoftBody<T>& body,
+             const std::vector<Polygon>& polys, double dt, RecordOptions options_)
+        : options(options_), pointCount(body.getPoints().size()) {
+        const BasicParticles<T>& points = body.getPoints();
+        std::vector<float>       radius(points.radius.begin(), points.radius.end());
+        std::vector<SpringF>     springs;
+        springs.reserve(body.getSprings().size());
+        for (const BasicSpring<T>& s: body.getSprings())
+            springs.push_back({s.a, s.b, static_cast<float>(s.rest), static_cast<float>(s.k),
+                               static_cast<float>(s.damp)});
+        open(path, dt, radius, springs, polys);
+    }
+
+    Recorder(const Recorder&) = delete;
+    Recorder& operator=(const Recorder&) = delete;
+
+    ~Recorder(); // writes the last, part full chunk, then stops and joins the writer
+
+    // Call after every step with the body's positions, which must be as many as when recording
+    // started. Keeps one in every stride
+    template <typename T>
+    void record(std::uint64_t step, std::span<const Vector2<T>> pos) {
+        if (++sinceFrame < options.stride) return;
+        sinceFrame = 0;
+        if (pos.size() != pointCount) throw std::logic_error("recorder: the body changed size");
+        if (chunk.frames == 0) chunk.firstStep = step;
+        const std::size_t at = chunk.pos.size();
+        chunk.pos.resize(at + pos.size());
+        for (std::size_t i = 0; i < pos.size(); i++) chunk.pos[at + i] = Vec2F(pos[i]);
+        ++frameCount;
+        if (++chunk.frames == static_cast<std::uint32_t>(options.framesPerChunk)) flush();
+    }
+
+    std::size_t   points() const { return pointCount; }
+    std::uint64_t frames() const { return frameCount; } // recorded so far, not all written yet
+    std::uint64_t bytesWritten() const { return written.load(std::memory_order_relaxed); }
+    bool          failed() const { return writeFailed.load(std::memory_order_relaxed); }
+
+  private:
+    struct Chunk {
+        std::uint64_t      firstStep = 0;
+        std::uint32_t      frames    = 0;
+        std::vector<Vec2F> pos; // frames x points
+    };
+
+    RecordOptions              options;
+    std::size_t                pointCount;
+    int                        sinceFrame = 0;
+    std::uint64_t              frameCount = 0;
+    Chunk                      chunk;
+    std::ofstream              file; // the writer's, once it has started
+    SpscQueue<Chunk, 16>       full;  // to the writer
+    SpscQueue<Chunk, 16>       empty; // back from it, to be re-used
+    std::atomic<std::uint64_t> taken{0}; // chunks the writer has popped, waited on when full
+    std::atomic<std::uint64_t> written{0};
+    std::atomic<bool>          writeFailed{false};
+    std::jthread               writer; // last, so it starts after everything above exists
+
+    void open(const std::string& path, double dt, std::span<const float> radius,
+              std::span<const SpringF> springs, const std::vector<Polygon>& polys);
+    void flush();
+    void write(const std::stop_token& stop);
+};
+
+// A read only memory map of a whole file. Throws std::runtime_error if it can't be opened, or is
+// empty
+class MappedFile {
+  public:
+    explicit MappedFile(const std::string& path);
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile();
+
+    std::span<const std::byte> bytes() const { return {data, size}; }
+
+  private:
+    const std::byte* data = nullptr;
+    std::size_t      size = 0;
+};
+
+// Plays back a recording straight from a memory map of the file, without running any physics.
+// Frames can be asked for in any order: going forwards within a chunk decodes only the frames in
+// between, anything else decodes from the start of the chunk.
+class Replay {
+  public:
+    // Throws std::runtime_error if path isn't a recording of this version. A chunk cut short ends
+    // the recording there rather than being an error
+    explicit Replay(const std::string& path);
+
+    std::size_t   frames() const { return frameCount; }
+    std::size_t   points() const { return pointCount; }
+    double        dt() const { return stepDt; }
+    int           stride() const { return frameStride; }
+    std::uint64_t step(std::size_t frame) const; // SimState::steps at it
+    std::size_t   bytes() const { return map.bytes().size(); }
+
+    const std::vector<float>&   radius() const { return radii; }
+    const std::vector<Spring>&  springs() const { return springList; }
+    const std::vector<Polygon>& polygons() const { return polys; }
+
+    // positions at frame < frames() into out. Throws std::runtime_error if the chunk is corrupt
+    void frame(std::size_t index, std::vector<Vec2>& out);
+
+  private:
+    struct ChunkIndex {
+        std::size_t   offset; // of its frames in the file
+        std::size_t   bytes;
+        std::size_t   firstFrame;
+        std::uint32_t frames;
+        std::uint64_t firstStep;
+    };
+
+    MappedFile              map;
+    std::size_t             pointCount  = 0;
+    int                     frameStride = 1;
+    int                     chunkFrames = 0; // most frames in any chunk
+    double                  stepDt      = 0;
+    double                  quantum     = 0;
+    std::size_t             frameCount  = 0;
+    std::vector<float>      radii;
+    std::vector<Spring>     springList;
+    std::vector<Polygon>    polys;
+    std::vector<ChunkIndex> chunks;
+
+    // where quantised decoding is up to, so playing forwards decodes each frame once
+    std::size_t               decodedChunk = 0;
+    std::size_t               nextFrame    = 0; // within decodedChunk
+    std::size_t               cursor       = 0; // byte offset of nextFrame
+    std::vector<std::int32_t> quantised;        // of the frame before nextFrame
+};
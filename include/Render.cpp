@@ -0,0 +1,89 @@
+#include "Render.hpp"
+#include "point_png.hpp"
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+
+sf::Vector2f visualize(const Vec2& v) {
+    return sf::Vector2f(static_cast<float>(v.x), static_cast<float>(v.y)) * vsScale;
+}
+
+BodyRenderer::BodyRenderer() {
+    if (!pointTexture.loadFromMemory(point_png, point_png_len))
+        throw std::runtime_error("BodyRenderer: could not load the point sprite");
+    pointTexture.setSmooth(true);
+}
+
+namespace {
+
+// writes the 2 triangles of the quad with corners c[0..3] (in winding order) at v[0..5]
+void quad(sf::Vertex* v, const sf::Vector2f (&c)[4], const sf::Vector2f (&t)[4], sf::Color col) {
+    constexpr int order[6] = {0, 1, 2, 0, 2, 3};
+    for (int i = 0; i < 6; i++) v[i] = sf::Vertex(c[order[i]], col, t[order[i]]);
+}
+
+} // namespace
+
+void BodyRenderer::draw(sf::RenderTarget& target, const SoftBody& sb) {
+    radii.assign(sb.getPoints().radius.begin(), sb.getPoints().radius.end());
+    draw(target, sb.getPoints().pos, radii, sb.getSprings());
+}
+
+void BodyRenderer::draw(sf::RenderTarget& target, const BodySnapshot& snap) {
+    if (snap.prevPos.size() != snap.pos.size()) {
+        draw(target, snap.pos, snap.radius, snap.springs);
+        return;
+    }
+    lerped.resize(snap.pos.size());
+    for (std::size_t i = 0; i < snap.pos.size(); i++)
+        lerped[i] = snap.prevPos[i] + (snap.pos[i] - snap.prevPos[i]) * snap.alpha;
+    draw(target, lerped, snap.radius, snap.springs);
+}
+
+void BodyRenderer::draw(sf::RenderTarget& target, std::span<const Vec2> pos,
+                        std::span<const float> radius, std::span<const Spring> springs) {
+    const std::size_t quads = pos.size() + (drawSprings ? springs.size() : 0);
+    vertices.resize(6 * quads); // keeps its capacity, so only allocates when the body grows
+
+    const auto         size = static_cast<float>(pointTexture.getSize().x);
+    const sf::Vector2f tex[4]{{0, 0}, {size, 0}, {size, size}, {0, size}};
+    std::size_t        v = 0;
+
+    if (drawSprings) {
+        // sampling only the middle of the sprite gives solid lines, tinted translucent so points
+        // stay visible on top
+        const sf::Vector2f mid(size / 2, size / 2);
+        const sf::Vector2f midTex[4]{mid, mid, mid, mid};
+        const sf::Color    tint(255, 255, 255, 96);
+        const float        halfWidth = 0.5F;
+        for (const Spring& s: springs) {
+            sf::Vector2f a   = visualize(pos[s.a]);
+            sf::Vector2f b   = visualize(pos[s.b]);
+            Vec2         n   = Vec2(a.y - b.y, b.x - a.x); // normal to the spring
+            double       len = n.mag();
+            if (len > 0) n *= halfWidth / len;
+            const sf::Vector2f off(static_cast<float>(n.x), static_cast<float>(n.y));
+            const sf::Vector2f c[4]{a + off, b + off, b - off, a - off};
+            quad(&vertices[v], c, midTex, tint);
+            v += 6;
+        }
+    }
+
+    for (std::size_t i = 0; i < pos.size(); i++) {
+        const sf::Vector2f p = visualize(pos[i]);
+        const float        r = radius[i] * vsScale;
+        const sf::Vector2f c[4]{p + sf::Vector2f(-r, -r), p + sf::Vector2f(r, -r),
+                                p + sf::Vector2f(r, r), p + sf::Vector2f(-r, r)};
+        quad(&vertices[v], c, tex, sf::Color::White);
+        v += 6;
+    }
+
+    target.draw(vertices, sf::RenderStates(&pointTexture));
+}
+
+void draw(sf::RenderWindow& window, const Polygon& poly) {
+    sf::ConvexShape shape;
+    shape.setPointCount(poly.pointCount);
+    for (std::size_t x = 0; x < poly.pointCount; x++) shape.setPoint(x, visualize(poly.points[x]));
+    window.draw(shape);
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "Polygon.hpp"
+#include "SFML/Graphics.hpp"
+#include "SimRunner.hpp"
+#include "SoftBody.hpp"
+#include "Spring.hpp"
+#include "Vector2.hpp"
+#include <span>
+#include <vector>
+
+// SFML drawing of the simulation objects. The simulation itself (softbody-core) knows nothing of
+// any of this.
+
+extern float vsScale; // pixels per simulation unit
+
+sf::Vector2f visualize(const Vec2& v);
+
+// Draws a whole body with one draw call: every point is a textured quad of the embedded point
+// sprite, all written into a single vertex array which is re-used from frame to frame.
+class BodyRenderer {
+  public:
+    bool drawSprings = false; // adds every spring as a thin quad to the same batch
+
+    BodyRenderer(); // needs an OpenGL context, ie create the window first
+
+    void draw(sf::RenderTarget& target, const SoftBody& sb);
+    // draws the snapshot's positions interpolated by its alpha, see FixedStepper
+    void draw(sf::RenderTarget& target, const BodySnapshot& snap);
+    void draw(sf::RenderTarget& target, std::span<const Vec2> pos, std::span<const float> radius,
+              std::span<const Spring> springs);
+
+  private:
+    sf::Texture        pointTexture;
+    sf::VertexArray    vertices{sf::Triangles};
+    std::vector<Vec2>  lerped; // interpolated snapshot positions
+    std::vector<float> radii;  // a body's radii, narrowed for drawing
+};
+
+void draw(sf::RenderWindow& window, const Polygon& poly);
@@ -0,0 +1,181 @@
+#include "SimRunner.hpp"
+#include "Stepper.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <utility>
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+// no display needs snapshots more often, and each one copies every position
+constexpr std::chrono::nanoseconds publishInterval{1'000'000};
+constexpr std::chrono::nanoseconds fpsInterval{250'000'000};
+// the profile is sorted to find its percentiles, so is only refreshed at a rate a person can read
+constexpr std::chrono::nanoseconds profileInterval{100'000'000};
+
+// into a buffer of snapshot positions, which are double whatever the simulation runs in.
+// Re-uses the buffer's capacity
+void widen(const std::vector<Vector2<SimScalar>>& from, std::vector<Vec2>& to) {
+    to.resize(from.size());
+    for (std::size_t i = 0; i < from.size(); i++) to[i] = Vec2(from[i]);
+}
+
+} // namespace
+
+SimRunner::SimRunner(SimState state)
+    : state_(std::move(state)), thread_([this](const std::stop_token& stop) { run(stop); }) {}
+
+SimRunner::~SimRunner() {
+    thread_.request_stop();
+    thread_.join();
+}
+
+bool SimRunner::post(Command cmd) { return commands_.push(std::move(cmd)); }
+
+bool SimRunner::record(std::string path, RecordOptions options) {
+    return post([this, path = std::move(path), options](SimState& s) {
+        s.recorder = nullptr;
+        recorder_.reset(); // first, in case it is the same file
+        try {
+            recorder_ = std::make_unique<Recorder>(path, s.body, s.polys, s.dt, options);
+        } catch (const std::exception&) {
+            return; // the snapshots say it isn't recording
+        }
+        s.recorder = recorder_.get();
+    });
+}
+
+bool SimRunner::stopRecording() {
+    return post([this](SimState& s) {
+        s.recorder = nullptr;
+        recorder_.reset();
+    });
+}
+
+const BodySnapshot& SimRunner::latest() {
+    snapshots_.update();
+    return snapshots_.front();
+}
+
+void SimRunner::publish(double alpha, double simFps) {
+    BodySnapshot&                    snap   = snapshots_.back();
+    const BasicParticles<SimScalar>& points = state_.body.getPoints();
+    widen(points.pos, snap.pos);
+    if (prevPos_.size() == points.size())
+        snap.prevPos.assign(prevPos_.begin(), prevPos_.end());
+    else
+        snap.prevPos.clear();
+    if (snap.topology != topology_) {
+        snap.radius.assign(points.radius.begin(), points.radius.end());
+        snap.springs.clear();
+        for (const BasicSpring<SimScalar>& s: state_.body.getSprings())
+            snap.springs.push_back({s.a, s.b, s.rest, s.k, s.damp});
+        snap.polys    = state_.polys;
+        snap.topology = topology_;
+    }
+    snap.alpha        = alpha;
+    snap.steps        = state_.steps;
+    snap.simFps       = simFps;
+    snap.dt           = state_.dt;
+    snap.dtBound      = state_.adaptive.bound();
+    snap.cgIterations = state_.body.integrator == Integrator::implicitEuler
+                            ? state_.body.implicit.iterations
+                            : 0;
+    snap.sdfBytes       = state_.collision == CollisionMode::exact ? 0 : state_.sdf.bytes();
+    snap.sdfError       = state_.sdfError;
+    snap.recording      = recorder_ != nullptr;
+    snap.recordedFrames = recorder_ != nullptr ? recorder_->frames() : 0;
+    snap.recordedBytes  = recorder_ != nullptr ? recorder_->bytesWritten() : 0;
+    snap.asleep         = state_.body.sleeper.asleep();
+    snap.restingRegions = state_.body.restingRegions();
+    snap.regionCount    = state_.body.regionCount();
+    snap.profile        = profile_;
+    snapshots_.publish();
+}
+
+void SimRunner::run(const std::stop_token& stop) {
+    ThreadPool pool;
+    state_.pool = &pool;
+    Profiler              profiler; // of the phases of every step
+    const InstallProfiler profiling(profiler);
+    nameTraceThread("Simulation");
+
+    FixedStepper  stepper(state_.dt, state_.maxSubsteps);
+    std::uint64_t fpsSteps  = state_.steps;
+    double        simFps    = 0;
+    auto          last      = clock_type::now();
+    auto          published = last - publishInterval;
+    auto          fpsStart  = last;
+    auto          profiled  = last;
+
+    state_.adaptive.update(state_.body);
+    publish(1.0, simFps); // so the renderer has something to draw straight away
+    while (!stop.stop_requested()) {
+        Command cmd;
+        while (commands_.pop(cmd)) {
+            SOFTBODY_TRACE("Command");
+            cmd(state_);
+            ++topology_;      // a command may have changed anything
+            prevPos_.clear(); // including the number of points
+            state_.rebuildCollision(); // and the polygons
+            state_.body.wake(); // and moved it, or what it rests on
+            state_.adaptive.update(state_.body); // or its springs and masses
+        }
+        // a recording has one body of one size, and ends with it
+        if (recorder_ != nullptr &&
+            (recorder_->points() != state_.body.getPoints().size() || recorder_->failed())) {
+            state_.recorder = nullptr;
+            recorder_.reset();
+        }
+
+        auto now     = clock_type::now();
+        auto elapsed = std::chrono::duration<double>(now - last).count();
+        last         = now;
+
+        // dt only changes between ticks, so a tick's steps are evenly paced
+        if (state_.adaptive.enabled) state_.dt = state_.adaptive.dt();
+        stepper.dt          = state_.dt;
+        stepper.maxSubsteps = state_.maxSubsteps;
+        int steps           = 0;
+        if (state_.paused)
+            stepper.reset();
+        else
+            steps = stepper.advance(elapsed);
+        if (steps > 0) {
+            SOFTBODY_TRACE("Substeps"); // each a Step, see Profiler.hpp
+            for (int i = 0; i < steps; i++) {
+                if (i == steps - 1) widen(state_.body.getPoints().pos, prevPos_);
+                state_.step();
+            }
+        }
+        const double alpha = state_.paused ? 1.0 : stepper.alpha();
+
+        if (now - fpsStart >= fpsInterval) {
+            simFps   = 1e9 * static_cast<double>(state_.steps - fpsSteps) /
+                     static_cast<double>((now - fpsStart).count());
+            fpsSteps = state_.steps;
+            fpsStart = now;
+        }
+        if (now - profiled >= profileInterval) {
+            for (std::size_t p = 0; p < phaseCount; p++)
+                profile_[p] = profiler.stats(static_cast<Phase>(p));
+            profiled = now;
+        }
+        if (now - published >= publishInterval) {
+            SOFTBODY_TRACE("Publish");
+            publish(alpha, simFps);
+            published = now;
+        }
+        // caught up with real time: sleep until the next step is due rather than spin. Paused,
+        // no step is ever due, so only wake as often as a snapshot or a command might be wanted
+        if (state_.paused)
+            std::this_thread::sleep_for(publishInterval);
+        else if (steps == 0)
+            std::this_thread::sleep_for(std::chrono::duration<double>(state_.dt * (1 - alpha)));
+    }
+    state_.pool = nullptr;
+}
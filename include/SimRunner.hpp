@@ -0,0 +1,228 @@
+#pragma once
+
+#include "Broadphase.hpp"
+#include "Checkpoint.hpp"
+#include "DistanceField.hpp"
+#include "Polygon.hpp"
+#include "Profiler.hpp"
+#include "Recording.hpp"
+#include "SoftBody.hpp"
+#include "SpscQueue.hpp"
+#include "StableDt.hpp"
+#include "Spring.hpp"
+#include "ThreadPool.hpp"
+#include "TripleBuffer.hpp"
+#include "Vector2.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// how SimState collides the body with its polygons. compare collides exactly, but also measures
+// how far the distance field is off at every point after each step
+enum class CollisionMode { exact, sdf, compare };
+
+inline constexpr const char* collisionModeNames[] = {"Exact", "Distance field", "Compare"};
+
+// The precision the app simulates in. Double unless built with SOFTBODY_FLOAT (the cmake option
+// of the same name), which trades accuracy for speed
+#ifdef SOFTBODY_FLOAT
+using SimScalar = float;
+#else
+using SimScalar = double;
+#endif
+using SimBody = BasicSoftBody<SimScalar>;
+
+// everything the simulation thread owns
+struct SimState {
+    SimBody                        body;
+    std::vector<Polygon>           polys;
+    double                         gravity       = 2.0;
+    double                         dt            = 1e-4; // seconds a step, or adaptive's choice
+    int                            maxSubsteps   = 100;  // catch-up steps per tick of the runner
+    bool                           paused        = false;
+    std::uint64_t                  steps         = 0;       // taken so far
+    ThreadPool*                    pool          = nullptr; // not owned
+    PolygonGrid                    grid          = {};      // over polys, see rebuildCollision()
+    CollisionMode                  collision     = CollisionMode::exact;
+    double                         sdfResolution = 16; // distance field cells per unit length
+    DistanceField                  sdf           = {};
+    SdfError                       sdfError      = {}; // of the last step, when comparing
+    Recorder*                      recorder      = nullptr; // not owned, given every step when set
+    BasicDtController<SimScalar>   adaptive      = {}; // update() it after changing the body
+    std::vector<std::vector<Vec2>> restoredPolys = {}; // restore()'s spare, so it doesn't allocate
+
+    // Call after moving or changing polys. Adding or removing them is picked up on the next step.
+    // The distance field is only baked when used, and only rebaked if the polygons or its
+    // resolution actually changed, as it costs far more than the grid
+    void rebuildCollision() {
+        grid.rebuild(polys);
+        if (collision == CollisionMode::exact)
+            sdf = {};
+        else if (sdf.resolution() != sdfResolution || !sdf.bakedFrom(polys))
+            sdf.build(polys, sdfResolution);
+    }
+
+    void step() {
+        SOFTBODY_TIME(Phase::step);
+        if (grid.polygonCount() != polys.size() ||
+            (collision != CollisionMode::exact && sdf.polygonCount() != polys.size()))
+            rebuildCollision();
+        adaptive.beforeStep(body.getPoints());
+        body.simFrame(dt, gravity, polys, pool, &grid,
+                      collision == CollisionMode::sdf ? &sdf : nullptr);
+        adaptive.afterStep(body.getPoints(), dt);
+        if (collision == CollisionMode::compare)
+            sdfError = measureSdfError(sdf, polys, grid, body.getPoints().pos);
+        ++steps;
+        if (recorder != nullptr) recorder->record<SimScalar>(steps, body.getPoints().pos);
+    }
+
+    // Deterministic offline mode: exactly n steps of dt, as fast as the CPU allows, each of
+    // adaptive.dt() if it is enabled. The same scene always ends in the same state, whatever the
+    // pool size.
+    void run(std::uint64_t n) {
+        for (std::uint64_t i = 0; i < n; i++) {
+            if (adaptive.enabled) dt = adaptive.dt();
+            step();
+        }
+    }
+
+    // The whole simulation as a compact binary checkpoint: the body, the polygons and the scene
+    // settings, into out, re-using its allocation. Restoring it carries on bit for bit where this
+    // left off, so long runs can be resumed from a file rather than simulated again
+    void save(std::vector<std::byte>& out) const {
+        CheckpointWriter writer(out);
+        body.save(writer);
+        writer.put(gravity);
+        writer.put(dt);
+        writer.put(steps);
+        writer.put(collision);
+        writer.put(sdfResolution);
+        adaptive.save(writer);
+        writer.put(static_cast<std::uint64_t>(polys.size()));
+        for (const Polygon& poly: polys) writer.putArray(std::span(poly.points));
+        writer.finish();
+    }
+
+    // Back to a checkpoint from save(), in place. With the same number of points and polygons
+    // nothing is reallocated, and the distance field is only rebaked if the polygons differ.
+    // Throws std::runtime_error on a checkpoint from another version or precision, or a damaged
+    // one, leaving the state as it was: everything is read and checked before any of it is taken
+    void restore(std::span<const std::byte> checkpoint) {
+        CheckpointReader reader(checkpoint);
+        body.readRestore(reader);
+        const auto nextGravity       = reader.get<double>();
+        const auto nextDt            = reader.get<double>();
+        const auto nextSteps         = reader.get<std::uint64_t>();
+        const auto nextCollision     = reader.get<CollisionMode>();
+        const auto nextSdfResolution = reader.get<double>();
+        BasicDtController<SimScalar> nextAdaptive; // settings only, its buffer stays empty
+        nextAdaptive.restore(reader);
+        const auto count = reader.get<std::uint64_t>();
+        if (count > checkpoint.size()) throw std::runtime_error("checkpoint: corrupt polygons");
+        if (restoredPolys.size() < count) restoredPolys.resize(count);
+        for (std::size_t p = 0; p < count; p++) {
+            reader.getArray(restoredPolys[p]);
+            if (restoredPolys[p].empty()) throw std::runtime_error("checkpoint: empty polygon");
+        }
+        const int collisionIndex = static_cast<int>(nextCollision);
+        if (collisionIndex < 0 || collisionIndex > static_cast<int>(CollisionMode::compare) ||
+            !(nextDt > 0) || !(nextSdfResolution > 0))
+            throw std::runtime_error("checkpoint: corrupt settings");
+
+        body.takeRestored();
+        gravity       = nextGravity;
+        dt            = nextDt;
+        steps         = nextSteps;
+        collision     = nextCollision;
+        sdfResolution = nextSdfResolution;
+        adaptive      = nextAdaptive; // copying an empty buffer keeps adaptive's allocation
+        adaptive.update(body);
+        while (polys.size() > count) polys.pop_back();
+        for (std::size_t p = 0; p < count; p++) {
+            if (p == polys.size()) polys.emplace_back(std::vector<Vec2>{Vec2()});
+            polys[p].points.assign(restoredPolys[p].begin(), restoredPolys[p].end());
+            polys[p].pointsChanged();
+        }
+        rebuildCollision();
+    }
+};
+
+// An immutable (once published) copy of what the renderer needs. Springs and polygons only change
+// on a command, so they are re-copied only when `topology` moves on. Always double, whatever the
+// simulation runs in.
+struct BodySnapshot {
+    std::vector<Vec2>    pos;
+    std::vector<Vec2>    prevPos; // one step before pos, empty if there is none to go by
+    double               alpha = 1; // how far real time is from prevPos to pos, see FixedStepper
+    std::vector<float>   radius;
+    std::vector<Spring>  springs;
+    std::vector<Polygon> polys;
+    std::uint64_t        topology     = 0;
+    std::uint64_t        steps        = 0; // SimState::steps
+    double               simFps       = 0;
+    double               dt           = 0; // SimState::dt, which adaptive may be choosing
+    double               dtBound      = 0; // the stability bound, infinite if there is none
+    int                  cgIterations = 0; // of the last implicit step, 0 for explicit ones
+    std::size_t          sdfBytes     = 0; // memory the distance field takes, 0 if unused
+    SdfError             sdfError;         // SimState::sdfError
+    bool                 recording      = false;
+    std::uint64_t        recordedFrames = 0; // of the recording going, if there is one
+    std::uint64_t        recordedBytes  = 0; // of it written so far
+    bool                 asleep         = false; // the body is at rest, see BasicSleeper
+    std::size_t          restingRegions = 0;     // or just these regions of it, see simFrame()
+    std::size_t          regionCount    = 0;
+    std::array<PhaseStats, phaseCount> profile; // of the simulation's phases, see Profiler
+};
+
+// Runs the simulation on its own thread, in fixed steps paced to real time by a FixedStepper.
+// The latest state is published through a lock-free triple buffer and changes come back through
+// a lock-free command queue, so neither the simulation nor the render thread ever waits for the
+// other.
+class SimRunner {
+  public:
+    using Command = std::function<void(SimState&)>;
+
+    explicit SimRunner(SimState state);
+
+    SimRunner(const SimRunner&) = delete;
+    SimRunner& operator=(const SimRunner&) = delete;
+
+    ~SimRunner(); // stops and joins the simulation thread
+
+    // Queues cmd to run on the simulation thread between two steps. Returns false (and drops it)
+    // if the queue is full. Render thread only.
+    bool post(Command cmd);
+
+    // Records the body to path from the next step (see Recorder), ending any recording already
+    // going. Whether it could start shows in the snapshots. Recording stops by itself if the body
+    // changes size or the file can't be written. Frames are timed by the dt it starts with, which
+    // an adaptive dt keeps unless it has an error tolerance. Both return false like post() if the
+    // queue is full. Render thread only.
+    bool record(std::string path, RecordOptions options);
+    bool stopRecording();
+
+    // The most recently published snapshot. Render thread only, and the reference stays valid
+    // until the next call.
+    const BodySnapshot& latest();
+
+  private:
+    SimState                   state_;
+    SpscQueue<Command, 64>     commands_;
+    TripleBuffer<BodySnapshot> snapshots_;
+    std::uint64_t              topology_ = 1;
+    std::vector<Vec2>          prevPos_; // positions before the last step
+    std::unique_ptr<Recorder>  recorder_; // simulation thread only, as state_.recorder
+    std::array<PhaseStats, phaseCount> profile_; // simulation thread only, as of last refresh
+    std::jthread               thread_; // last, so it starts after everything above exists
+
+    void run(const std::stop_token& stop);
+    void publish(double alpha, double simFps);
+};
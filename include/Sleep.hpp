@@ -0,0 +1,83 @@
+#pragma once
+
+#include "Particles.hpp"
+#include "Vector2.hpp"
+#include "damper.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+// Rest detection for a body, or any other range of particles which move together, such as one
+// region of a large body. Once their kinetic energy has stayed low for long enough the body can
+// be put to sleep: it stops being simulated, its velocities are zeroed, and it stays exactly
+// where it is until woken.
+//
+// Two thresholds, both in energy per point: the mean kinetic energy over the body, smoothed by
+// a damper so a single still moment (the top of a bounce) isn't mistaken for rest, and the
+// kinetic energy of the fastest point, so one corner still flapping keeps the whole body awake.
+//
+// Plain data, so a sleeper can be checkpointed as it is.
+template <typename T>
+class BasicSleeper {
+  public:
+    // A body resting on a polygon never quite stops: each step gravity pulls its lowest points in
+    // and the collision pushes them back out, leaving energies of order (g dt)^2 / 2. These
+    // defaults sit well above that for the app's g = 2 and dt = 1e-4
+    bool enabled     = false;
+    T    meanEnergy  = T(1e-6); // the smoothed mean must fall below this,
+    T    pointEnergy = T(1e-5); // and every point's below this, to fall asleep
+
+    // timeConstant: the steps the mean is smoothed over, and the least a body must have been
+    // awake before it can sleep again
+    explicit BasicSleeper(short timeConstant_ = 500)
+        : timeConstant(timeConstant_), smoothed(timeConstant_) {}
+
+    [[nodiscard]] bool asleep() const { return sleeping; }
+    [[nodiscard]] T    energy() const { return smoothed.current(); } // the smoothed mean
+
+    // Call after every step with the body's particles [begin, end). Returns true if that step
+    // sent it to sleep, when its velocities have been zeroed and it should no longer be stepped
+    bool update(BasicParticles<T>& ps, std::size_t begin, std::size_t end) {
+        return update(ps, begin, end - begin, end - begin, end > begin ? 1 : 0);
+    }
+
+    // The same for `runs` runs of `length` particles, `stride` apart from first: a rectangle of a
+    // grid, for one region of a large body
+    bool update(BasicParticles<T>& ps, std::size_t first, std::size_t length, std::size_t stride,
+                std::size_t runs) {
+        if (!enabled || sleeping || length == 0 || runs == 0) return false;
+        T sum  = 0;
+        T most = 0;
+        for (std::size_t r = 0; r < runs; r++) {
+            for (std::size_t i = first + r * stride; i < first + r * stride + length; i++) {
+                const T e = ps.vel[i].dot(ps.vel[i]) / (2 * ps.invMass[i]);
+                sum += e;
+                most = std::max(most, e);
+            }
+        }
+        const T mean = smoothed(sum / static_cast<T>(length * runs));
+        if (awakeSteps < timeConstant) ++awakeSteps;
+        if (awakeSteps < timeConstant || mean >= meanEnergy || most >= pointEnergy) return false;
+        sleeping = true;
+        for (std::size_t r = 0; r < runs; r++) {
+            const auto at = ps.vel.begin() + static_cast<std::ptrdiff_t>(first + r * stride);
+            std::fill(at, at + static_cast<std::ptrdiff_t>(length), Vector2<T>());
+        }
+        return true;
+    }
+
+    // back to being simulated, with its rest detection starting over
+    void wake() {
+        sleeping   = false;
+        awakeSteps = 0;
+        smoothed.reset();
+    }
+
+  private:
+    short     timeConstant;
+    short     awakeSteps = 0;
+    bool      sleeping   = false;
+    damper<T> smoothed;
+};
+
+using Sleeper = BasicSleeper<double>;
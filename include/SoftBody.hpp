@@ -0,0 +1,624 @@
+#pragma once
+
+#include "Broadphase.hpp"
+#include "CellList.hpp"
+#include "Checkpoint.hpp"
+#include "Collision.hpp"
+#include "DistanceField.hpp"
+#include "Implicit.hpp"
+#include "Integrator.hpp"
+#include "Particles.hpp"
+#include "Polygon.hpp"
+#include "Profiler.hpp"
+#include "Sleep.hpp"
+#include "Spring.hpp"
+#include "SpringKernel.hpp"
+#include "ThreadPool.hpp"
+#include "Vector2.hpp"
+#include "Xpbd.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+// Pushes particles [begin, end) which have ended up inside a polygon back out onto its surface,
+// reflecting their velocity, on this thread. grid and sdf as in SoftBody::simFrame()
+template <typename T>
+void collidePolygons(BasicParticles<T>& ps, std::size_t begin, std::size_t end,
+                     const std::vector<Polygon>& polys, const PolygonGrid* grid,
+                     const DistanceField* sdf) {
+    for (std::size_t i = begin; i < end; i++) {
+        if (sdf != nullptr) {
+            sdfColHandler(ps.pos[i], ps.vel[i], *sdf);
+        } else if (grid != nullptr) {
+            grid->forEachBounding(polys, ps.pos[i], [&](const Polygon& poly) {
+                polyColHandler(ps.pos[i], ps.vel[i], poly);
+            });
+        } else {
+            for (const Polygon& poly: polys) {
+                if (poly.isBounded(Vec2(ps.pos[i]))) polyColHandler(ps.pos[i], ps.vel[i], poly);
+            }
+        }
+    }
+}
+
+// all of them. Each point only ever touches itself, so they can be split across threads
+template <typename T>
+void collidePolygons(BasicParticles<T>& ps, const std::vector<Polygon>& polys,
+                     const PolygonGrid* grid, ThreadPool* pool, const DistanceField* sdf) {
+    parallelFor(pool, ps.size(), [&](std::size_t begin, std::size_t end) {
+        collidePolygons(ps, begin, end, polys, grid, sdf);
+    });
+}
+
+// A rectangular grid of particles joined by springs. Pure simulation: drawing lives in Render.hpp
+//
+// Everything the body simulates in is T: its particles, springs, parameters and solvers. Use
+// SoftBody (double) for reference runs and SoftBodyF (float) for interactive ones, which moves
+// half the bytes per step and fits twice as many lanes in each SIMD instruction. The polygons
+// are double either way, a float body's points are widened just for the collision tests.
+template <typename T>
+class BasicSoftBody {
+  public:
+    using Scalar = T;
+
+    Vec2I                  size;
+    Vector2<T>             simPos;
+    T                      springConst = 8000;
+    T                      dampFact    = 100;
+    T                      gap;
+    Simd                   simd       = detectSimd();
+    Integrator             integrator = Integrator::symplecticEuler;
+    BasicImplicitSolver<T> implicit; // cg settings, and stats of the last implicitEuler step
+    BasicXpbdSolver<T>     xpbd;     // iterations for Integrator::xpbd
+    bool                   selfCollision = false; // points push apart when the body folds
+    BasicSleeper<T>        sleeper; // rest detection, off unless enabled. wake() after any change
+
+  private:
+    BasicParticles<T>           points;
+    std::vector<BasicSpring<T>> springs; // ordered by colour batch, see colourSprings()
+    std::vector<std::size_t>    springBatches;
+    SpringColouring<T>          colouring; // kept so updateSprings() doesn't allocate
+    BasicIntegratorScratch<T>   scratch;
+    BasicCellList<T>            cells; // for self collision, kept up to date every step
+    static constexpr T          radius = T(0.05);
+
+    // what readRestore() reads into, in save() order, kept so restoring again doesn't allocate
+    struct Restored {
+        Vec2I                        size;
+        Vector2<T>                   simPos;
+        T                            springConst           = 0;
+        T                            dampFact              = 0;
+        T                            gap                   = 0;
+        Integrator                   integrator            = Integrator::symplecticEuler;
+        T                            implicitTolerance     = 0;
+        int                          implicitMaxIterations = 0;
+        int                          xpbdIterations        = 0;
+        bool                         selfCollision         = false;
+        BasicSleeper<T>              sleeper;
+        int                          cols = 0;
+        int                          rows = 0;
+        std::vector<Vector2<T>>      pos;
+        std::vector<Vector2<T>>      vel;
+        std::vector<T>               invMass;
+        std::vector<T>               radius;
+        std::vector<BasicSpring<T>>  springs;
+        std::vector<std::size_t>     springBatches;
+        std::vector<BasicSleeper<T>> regions;
+        bool                         ready = false; // read and checked, but not yet taken
+    };
+    Restored restored;
+
+    // grid dimensions `points` was built with. `size` is what the UI asks for and only takes
+    // effect on reset()
+    int cols = 0;
+    int rows = 0;
+
+    // Regions of a large body at rest, see simFrame(): the grid cut into tiles of regionSize
+    // points square, each with its own sleeper, and what a step of only the awake ones needs,
+    // rebuilt by indexAwake() when a region falls asleep or wakes
+    struct Run { // of points, [begin, end)
+        std::size_t begin;
+        std::size_t end;
+    };
+    struct Boundary { // a spring from an awake point to a region at rest
+        std::uint32_t point;
+        std::uint32_t region;
+    };
+    static constexpr std::size_t regionSize = 8;
+    std::vector<BasicSleeper<T>> regions; // row major over the tiles
+    std::size_t                  regionCols     = 0;
+    bool                         regionsChanged = true;
+    std::vector<BasicSpring<T>>  awakeSprings; // those with an end awake, in the same order
+    std::vector<std::size_t>     awakeBatches;
+    std::vector<Boundary>        boundary;
+    std::vector<Run>             awakeRuns;
+    std::vector<Run>             restingRuns;
+
+    // every point has the same radius, so two can only touch within one diameter
+    static constexpr T contactReach() { return 2 * radius; }
+
+    std::size_t index(int x, int y) const { return static_cast<std::size_t>(x + y * cols); }
+
+    // Moves the first keepCols points of the first keepRows rows from where they were with
+    // oldCols columns to where they go with cols, in place. Going right to left when the rows
+    // grow, so nothing is overwritten before it has moved
+    template <typename V>
+    void regrid(std::vector<V>& v, int oldCols, int keepCols, int keepRows) const {
+        auto from = [&](int y) { return v.begin() + static_cast<std::ptrdiff_t>(y * oldCols); };
+        auto to   = [&](int y) { return v.begin() + static_cast<std::ptrdiff_t>(y * cols); };
+        if (cols > oldCols) {
+            for (int y = keepRows - 1; y > 0; y--)
+                std::copy_backward(from(y), from(y) + keepCols, to(y) + keepCols);
+        } else if (cols < oldCols) {
+            for (int y = 1; y < keepRows; y++) std::copy(from(y), from(y) + keepCols, to(y));
+        }
+    }
+
+    // the tile point i is in
+    [[nodiscard]] std::size_t regionOf(std::size_t i) const {
+        const auto c = static_cast<std::size_t>(cols);
+        return i % c / regionSize + i / c / regionSize * regionCols;
+    }
+
+    [[nodiscard]] static std::size_t regionsAcross(int points) {
+        return (static_cast<std::size_t>(points) + regionSize - 1) / regionSize;
+    }
+
+    // only with symplectic Euler, the others step the whole body at once
+    [[nodiscard]] bool usesRegions() const {
+        return sleeper.enabled && integrator == Integrator::symplecticEuler && regions.size() > 1;
+    }
+
+    // new regions for the grid as it is now, all awake, with sleeper's thresholds
+    void buildRegions() {
+        regionCols = regionsAcross(cols);
+        regions.assign(regionCols * regionsAcross(rows), sleeper);
+        for (BasicSleeper<T>& region: regions) region.wake();
+        regionsChanged = true;
+    }
+
+    void wakeRegion(std::size_t r) {
+        if (!regions[r].asleep()) return;
+        regions[r].wake();
+        regionsChanged = true;
+    }
+
+    // The springs, batches and runs of points restingStep() needs, for the regions at rest now.
+    // Filtering the colour sorted springs in order keeps each batch free of shared points
+    void indexAwake() {
+        auto asleep = [&](std::size_t i) { return regions[regionOf(i)].asleep(); };
+        awakeSprings.clear();
+        awakeBatches.clear();
+        boundary.clear();
+        for (std::size_t c = 0; c + 1 < springBatches.size(); c++) {
+            awakeBatches.push_back(awakeSprings.size());
+            for (std::size_t k = springBatches[c]; k < springBatches[c + 1]; k++) {
+                const BasicSpring<T>& sp      = springs[k];
+                const bool            aAsleep = asleep(sp.a);
+                const bool            bAsleep = asleep(sp.b);
+                if (aAsleep && bAsleep) continue;
+                awakeSprings.push_back(sp);
+                if (aAsleep == bAsleep) continue;
+                const std::uint32_t awake   = aAsleep ? sp.b : sp.a;
+                const std::uint32_t resting = aAsleep ? sp.a : sp.b;
+                boundary.push_back({awake, static_cast<std::uint32_t>(regionOf(resting))});
+            }
+        }
+        awakeBatches.push_back(awakeSprings.size());
+
+        awakeRuns.clear();
+        restingRuns.clear();
+        for (std::size_t i = 0; i < points.size();) {
+            const bool  resting = asleep(i);
+            std::size_t end     = i + 1;
+            while (end < points.size() && asleep(end) == resting) end++;
+            (resting ? restingRuns : awakeRuns).push_back({i, end});
+            i = end;
+        }
+        regionsChanged = false;
+    }
+
+    // A symplectic Euler step of only the regions which are awake: the springs with an end
+    // awake, contacts, and integration and the polygons for awake points. Points at rest stay
+    // exactly where they are, so to the awake ones they are fixed. Then wakes every region at rest
+    // which an awake point has disturbed, by pulling on a spring to it or by touching it
+    void restingStep(T dt, const Vector2<T>& g, const std::vector<Polygon>& polys,
+                     ThreadPool* pool, const PolygonGrid* grid, const DistanceField* sdf) {
+        if (regionsChanged) indexAwake();
+        {
+            SOFTBODY_TIME(Phase::springs);
+            if (pool != nullptr)
+                springForces(points, awakeSprings, awakeBatches, *pool, simd);
+            else
+                springForces(points, awakeSprings, simd);
+        }
+        contactPhase(pool);
+        {
+            SOFTBODY_TIME(Phase::integrate);
+            parallelFor(
+                pool, awakeRuns.size(),
+                [&](std::size_t begin, std::size_t end) {
+                    for (std::size_t r = begin; r < end; r++)
+                        integrate(points, awakeRuns[r].begin, awakeRuns[r].end, dt, g, simd);
+                },
+                1);
+            for (const Run& run: restingRuns) { // forces from awake points, which it ignores
+                std::fill(points.f.begin() + static_cast<std::ptrdiff_t>(run.begin),
+                          points.f.begin() + static_cast<std::ptrdiff_t>(run.end), Vector2<T>());
+            }
+        }
+        {
+            SOFTBODY_TIME(Phase::polygons);
+            parallelFor(
+                pool, awakeRuns.size(),
+                [&](std::size_t begin, std::size_t end) {
+                    for (std::size_t r = begin; r < end; r++)
+                        collidePolygons(points, awakeRuns[r].begin, awakeRuns[r].end, polys,
+                                        grid, sdf);
+                },
+                1);
+        }
+
+        // a point moving faster than a region sleeps at is a disturbance, one just settling isn't
+        for (const Boundary& edge: boundary) {
+            const Vector2<T>& v = points.vel[edge.point];
+            if (v.dot(v) / (2 * points.invMass[edge.point]) >= sleeper.pointEnergy)
+                wakeRegion(edge.region);
+        }
+        if (!selfCollision) return;
+        // on one thread, as two pairs may wake the same region
+        cells.forEachPair(nullptr, [&](std::uint32_t i, std::uint32_t j) {
+            const std::size_t a = regionOf(i);
+            const std::size_t b = regionOf(j);
+            if (regions[a].asleep() == regions[b].asleep()) return;
+            const Vector2<T> d = points.pos[j] - points.pos[i];
+            if (d.dot(d) < contactReach() * contactReach()) wakeRegion(regions[a].asleep() ? a : b);
+        });
+    }
+
+    // after a step, puts each region which has come to rest to sleep
+    void updateRegions() {
+        const auto c = static_cast<std::size_t>(cols);
+        const auto r = static_cast<std::size_t>(rows);
+        for (std::size_t k = 0; k < regions.size(); k++) {
+            BasicSleeper<T>& region = regions[k];
+            region.enabled          = true;
+            region.meanEnergy       = sleeper.meanEnergy;
+            region.pointEnergy      = sleeper.pointEnergy;
+            const std::size_t x     = k % regionCols * regionSize;
+            const std::size_t y     = k / regionCols * regionSize;
+            if (region.update(points, x + y * c, std::min(regionSize, c - x), c,
+                              std::min(regionSize, r - y)))
+                regionsChanged = true;
+        }
+    }
+
+  public:
+    BasicSoftBody(const Vec2I& size_, T gap_, const Vector2<T>& simPos_, T springConst_,
+                  T dampFact_)
+        : size(size_), simPos(simPos_), springConst(springConst_), dampFact(dampFact_),
+          gap(gap_) {
+        reset();
+    }
+
+    // Back to an undeformed grid of `size` at simPos, at rest, with springs from the current
+    // gap, springConst and dampFact. Every other setting is kept, and the particle arrays keep
+    // their allocations
+    void reset() {
+        cols = size.x;
+        rows = size.y;
+        points.clear();
+        points.reserveGrowing(static_cast<std::size_t>(cols * rows));
+        for (int y = 0; y < rows; y++) {
+            for (int x = 0; x < cols; x++) {
+                points.add(Vector2<T>(static_cast<T>(x), static_cast<T>(y)) * gap + simPos, 1,
+                           radius);
+            }
+        }
+        updateSprings();
+    }
+
+    // Grows or shrinks the grid to newSize by adding or removing columns at the right and rows
+    // at the bottom, without disturbing the rest: points which stay keep their position,
+    // velocity and mass, and new ones start a gap on from their nearest old neighbour, moving
+    // with it. Springs are re-derived as by updateSprings(). Storage grows geometrically and
+    // never shrinks, so dragging the size up a row at a time reallocates only now and then
+    void resize(const Vec2I& newSize) {
+        const int oldCols = cols;
+        const int oldRows = rows;
+        size              = Vec2I(std::max(newSize.x, 0), std::max(newSize.y, 0));
+        if (oldCols == 0 || oldRows == 0) { // nothing to grow from
+            reset();
+            return;
+        }
+        cols = size.x;
+        rows = size.y;
+        const int         keepCols = std::min(cols, oldCols);
+        const int         keepRows = std::min(rows, oldRows);
+        const std::size_t n        = static_cast<std::size_t>(cols * rows);
+        const std::size_t oldN     = points.size();
+
+        points.reserveGrowing(n);
+        points.resize(std::max(n, oldN));
+        regrid(points.pos, oldCols, keepCols, keepRows);
+        regrid(points.vel, oldCols, keepCols, keepRows);
+        regrid(points.invMass, oldCols, keepCols, keepRows);
+        regrid(points.radius, oldCols, keepCols, keepRows);
+        points.resize(n);
+        for (int y = 0; y < rows; y++) {
+            for (int x = y < keepRows ? keepCols : 0; x < cols; x++) {
+                const int         nearX   = std::min(x, keepCols - 1);
+                const int         nearY   = std::min(y, keepRows - 1);
+                const std::size_t nearest = index(nearX, nearY);
+                const std::size_t i       = index(x, y);
+                const Vector2<T>  offset(static_cast<T>(x - nearX), static_cast<T>(y - nearY));
+                points.pos[i]     = points.pos[nearest] + offset * gap;
+                points.vel[i]     = points.vel[nearest];
+                points.invMass[i] = 1;
+                points.radius[i]  = radius;
+            }
+        }
+        std::fill(points.f.begin(), points.f.end(), Vector2<T>()); // clear between steps
+        updateSprings();
+    }
+
+    // Everything needed to carry on exactly where the body is now: its parameters and settings,
+    // particles and springs. Not the SIMD level, which belongs to the machine
+    void save(CheckpointWriter& out) const {
+        out.put(static_cast<std::uint32_t>(sizeof(T)));
+        out.put(size);
+        out.put(simPos);
+        out.put(springConst);
+        out.put(dampFact);
+        out.put(gap);
+        out.put(integrator);
+        out.put(implicit.tolerance);
+        out.put(implicit.maxIterations);
+        out.put(xpbd.iterations);
+        out.put(selfCollision);
+        out.put(sleeper);
+        out.put(cols);
+        out.put(rows);
+        out.putArray(std::span(points.pos));
+        out.putArray(std::span(points.vel));
+        out.putArray(std::span(points.invMass));
+        out.putArray(std::span(points.radius));
+        out.putArray(std::span(springs));
+        out.putArray(std::span(springBatches));
+        out.putArray(std::span(regions));
+    }
+
+    // Reads back what save() wrote, in place: the arrays re-use their allocations, so restoring
+    // a body of the same size allocates nothing. Throws std::runtime_error if the checkpoint is
+    // from a body of the other precision or doesn't hold together, leaving the body as it was
+    void restore(CheckpointReader& in) {
+        readRestore(in);
+        takeRestored();
+    }
+
+    // restore() in two halves, for restoring along with other state that might still turn out
+    // bad: readRestore() reads and checks the body into spare buffers, throwing as above, and only
+    // takeRestored() changes anything
+    void readRestore(CheckpointReader& in) {
+        if (in.get<std::uint32_t>() != sizeof(T))
+            throw std::runtime_error("checkpoint: body saved in another precision");
+        Restored& r = restored;
+        r.ready     = false;
+        in.get(r.size);
+        in.get(r.simPos);
+        in.get(r.springConst);
+        in.get(r.dampFact);
+        in.get(r.gap);
+        in.get(r.integrator);
+        in.get(r.implicitTolerance);
+        in.get(r.implicitMaxIterations);
+        in.get(r.xpbdIterations);
+        in.get(r.selfCollision);
+        in.get(r.sleeper);
+        in.get(r.cols);
+        in.get(r.rows);
+        in.getArray(r.pos);
+        in.getArray(r.vel);
+        in.getArray(r.invMass);
+        in.getArray(r.radius);
+        in.getArray(r.springs);
+        in.getArray(r.springBatches);
+        in.getArray(r.regions);
+
+        const std::size_t n      = r.pos.size();
+        const int         method = static_cast<int>(r.integrator);
+        bool              ok     = method >= 0 && method <= static_cast<int>(Integrator::xpbd);
+        ok = ok && r.cols >= 0 && r.rows >= 0;
+        ok = ok && static_cast<std::size_t>(r.cols) * static_cast<std::size_t>(r.rows) == n;
+        ok = ok && r.vel.size() == n && r.invMass.size() == n && r.radius.size() == n;
+        ok = ok && !r.springBatches.empty() && r.springBatches.front() == 0 &&
+             r.springBatches.back() == r.springs.size();
+        for (std::size_t c = 1; c < r.springBatches.size(); c++)
+            ok = ok && r.springBatches[c - 1] <= r.springBatches[c];
+        for (const BasicSpring<T>& sp: r.springs) ok = ok && sp.a < n && sp.b < n;
+        ok = ok && r.regions.size() == regionsAcross(r.cols) * regionsAcross(r.rows);
+        if (!ok) throw std::runtime_error("checkpoint: corrupt body");
+        r.ready = true;
+    }
+
+    // Copies rather than swaps, so the body keeps its own allocations. Does nothing unless the
+    // last readRestore() succeeded
+    void takeRestored() {
+        Restored& r = restored;
+        if (!r.ready) return;
+        r.ready                = false;
+        size                   = r.size;
+        simPos                 = r.simPos;
+        springConst            = r.springConst;
+        dampFact               = r.dampFact;
+        gap                    = r.gap;
+        integrator             = r.integrator;
+        implicit.tolerance     = r.implicitTolerance;
+        implicit.maxIterations = r.implicitMaxIterations;
+        xpbd.iterations        = r.xpbdIterations;
+        selfCollision          = r.selfCollision;
+        sleeper                = r.sleeper;
+        cols                   = r.cols;
+        rows                   = r.rows;
+        points.pos.assign(r.pos.begin(), r.pos.end());
+        points.vel.assign(r.vel.begin(), r.vel.end());
+        points.invMass.assign(r.invMass.begin(), r.invMass.end());
+        points.radius.assign(r.radius.begin(), r.radius.end());
+        springs.assign(r.springs.begin(), r.springs.end());
+        springBatches.assign(r.springBatches.begin(), r.springBatches.end());
+        regions.assign(r.regions.begin(), r.regions.end());
+        regionCols     = regionsAcross(cols);
+        regionsChanged = true;
+        points.f.assign(points.size(), Vector2<T>()); // always clear between steps
+    }
+
+    // Re-derives every spring's rest length, stiffness and damping from the body wide `gap`,
+    // `springConst` and `dampFact`, overwriting any per-spring values. Call after changing those.
+    void updateSprings() {
+        gridSprings<T>(cols, rows, gap, springConst, dampFact, springs);
+        colourSprings(springs, points.size(), springBatches, colouring);
+        buildRegions();
+        sleeper.wake();
+    }
+
+    // Back to being simulated, the whole body and every region of it. Call after any change to
+    // the body, or to what it rests on
+    void wake() {
+        sleeper.wake();
+        for (BasicSleeper<T>& region: regions) region.wake();
+        regionsChanged = true;
+    }
+
+    // regions of a large body at rest while the rest of it moves, see simFrame()
+    [[nodiscard]] std::size_t restingRegions() const {
+        return static_cast<std::size_t>(
+            std::ranges::count_if(regions, [](const BasicSleeper<T>& r) { return r.asleep(); }));
+    }
+    [[nodiscard]] std::size_t regionCount() const { return regions.size(); }
+
+    // individual springs, for giving them their own rest length, stiffness or damping. wake()
+    // after changing them
+    std::span<BasicSpring<T>> getSprings() { return springs; }
+
+    [[nodiscard]] const BasicParticles<T>&          getPoints() const { return points; }
+    [[nodiscard]] std::span<const BasicSpring<T>> getSprings() const { return springs; }
+
+    // One step of the simulation. With a pool the springs and integration are spread over its
+    // threads; the result is bit identical to running without one. Likewise with a grid built
+    // over polys, which only saves testing the polygons far from each point. With a distance
+    // field baked from polys it collides against that instead, which is approximate. Does nothing
+    // while the body is asleep and sleeper is still enabled.
+    //
+    // With symplectic Euler a body too big to come to rest all at once can rest in parts: with
+    // the sleeper enabled, each square region of regionSize points has a sleeper of its own with
+    // the same thresholds, and once one falls asleep only the rest of the body is stepped, the
+    // points at rest held where they are. While every region is awake the step is the same as
+    // without regions, bit for bit
+    void simFrame(double deltaTime, double gravity, const std::vector<Polygon>& polys,
+                  ThreadPool* pool = nullptr, const PolygonGrid* grid = nullptr,
+                  const DistanceField* sdf = nullptr) {
+        if (sleeper.asleep()) {
+            if (sleeper.enabled) return; // nothing moves until it is woken
+            sleeper.wake();              // or until sleeping is turned off
+        }
+        const bool regional = usesRegions();
+        if (!regional) { // none may stay at rest
+            for (std::size_t r = 0; r < regions.size(); r++) wakeRegion(r);
+        }
+        const bool partial = regional && restingRegions() > 0;
+        const auto       dt = static_cast<T>(deltaTime);
+        const Vector2<T> g(0, static_cast<T>(gravity)); // an acceleration, independent of mass
+        auto             forces = [&] {
+            springPhase(pool);
+            contactPhase(pool);
+        };
+        switch (integrator) {
+        case Integrator::symplecticEuler:
+            if (partial) {
+                restingStep(dt, g, polys, pool, grid, sdf);
+                break;
+            }
+            forces();
+            integratePhase(deltaTime, gravity, pool);
+            break;
+        case Integrator::verlet: {
+            SOFTBODY_TIME(Phase::integrate);
+            verletStep(points, dt, g, pool, forces);
+            break;
+        }
+        case Integrator::rk4: {
+            SOFTBODY_TIME(Phase::integrate);
+            rk4Step(points, dt, g, pool, scratch, forces);
+            break;
+        }
+        case Integrator::implicitEuler: { // contacts are explicit, only the springs implicit
+            forces();
+            SOFTBODY_TIME(Phase::integrate);
+            implicit.step(points, springs, springBatches, dt, g, pool);
+            break;
+        }
+        case Integrator::xpbd: { // collides as part of its constraint solve
+            if (selfCollision) {
+                SOFTBODY_TIME(Phase::broadphase);
+                // with slack for points which come together during the iterations
+                cells.build(points.pos, T(1.5) * contactReach());
+            }
+            SOFTBODY_TIME(Phase::integrate);
+            xpbd.step(points, springs, springBatches, polys, grid, sdf,
+                      selfCollision ? &cells : nullptr, dt, g, pool);
+            break;
+        }
+        }
+        if (integrator != Integrator::xpbd && !partial) collisionPhase(polys, grid, pool, sdf);
+        sleeper.update(points, 0, points.size());
+        if (regional) updateRegions();
+    }
+
+    // the phases of simFrame, exposed individually for benchmarking
+
+    // accumulates every spring's force into its particles
+    void springPhase(ThreadPool* pool = nullptr) {
+        SOFTBODY_TIME(Phase::springs);
+        if (pool != nullptr)
+            springForces(points, springs, springBatches, *pool, simd);
+        else
+            springForces(points, springs, simd);
+    }
+
+    // adds the push between points which overlap, if selfCollision is on
+    void contactPhase(ThreadPool* pool = nullptr) {
+        if (!selfCollision) return;
+        {
+            SOFTBODY_TIME(Phase::broadphase);
+            cells.build(points.pos, contactReach());
+        }
+        SOFTBODY_TIME(Phase::narrowphase);
+        contactForces(points, cells, springConst, dampFact, pool);
+    }
+
+    // zeroes the forces the phases above accumulate, as integration does
+    void clearForces() { points.f.assign(points.size(), Vector2<T>()); }
+
+    // symplectic euler: moves every particle on by deltaTime and clears the accumulated forces
+    void integratePhase(double deltaTime, double gravity, ThreadPool* pool = nullptr) {
+        SOFTBODY_TIME(Phase::integrate);
+        const auto       dt = static_cast<T>(deltaTime);
+        const Vector2<T> g(0, static_cast<T>(gravity));
+        parallelFor(pool, points.size(), [&](std::size_t begin, std::size_t end) {
+            integrate(points, begin, end, dt, g, simd);
+        });
+    }
+
+    // pushes particles which have ended up inside a polygon back out onto its surface
+    void collisionPhase(const std::vector<Polygon>& polys, const PolygonGrid* grid = nullptr,
+                        ThreadPool* pool = nullptr, const DistanceField* sdf = nullptr) {
+        SOFTBODY_TIME(Phase::polygons);
+        collidePolygons(points, polys, grid, pool, sdf);
+    }
+};
+
+using SoftBody  = BasicSoftBody<double>;
+using SoftBodyF = BasicSoftBody<float>;
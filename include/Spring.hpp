@@ -1,39 +1,137 @@
 #pragma once
 
-#include "Point.hpp"
+#include "Particles.hpp"
 #include "Vector2.hpp"
-#include "damper.hpp"
-
-class Spring {
-  public:
-    Point& p1;
-    Point& p2;
-    double length;
-    double springConstant;
-    double dampFactor;
-    // too much noise in this differential veclocity vector will make the system unstable with high
-    // dampFactors. So we use a `damper` (exponential damping) to smooth out the noise
-    damper<Vec2> dampedExtensionVelocity;
-
-    static constexpr unsigned exponentialDampingTimeConstant = 8;
-    
-    Spring(Point& p1_, Point& p2_, double length_, double springConstant_, double dampFactor_)
-        : p1(p1_), p2(p2_), length(length_), springConstant(springConstant_), dampFactor(dampFactor_),
-          dampedExtensionVelocity(exponentialDampingTimeConstant) {}
-
-    void updatePointForces() {
-        Vec2   diff     = p1.pos - p2.pos; // broken out alot "yes this is faster! really like 3x"
-        double diffMag  = diff.mag();
-        Vec2   diffNorm = diff / diffMag;
-        double ext      = diffMag - length;
-        double springf  = -springConstant * ext; // -ke spring force and also if a diagonal increase
-                                                 // spring constant for stability // test
-
-        // damping force: note the use of a `damper` to smooth out noise in differential veclocity
-        double dampf =
-            diffNorm.dot(dampedExtensionVelocity(p2.vel - p1.vel)) * dampFactor;
-        Vec2 force = (springf + dampf) * diffNorm;
-        p1.f += force; // equal and opposite reaction
-        p2.f -= force;
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <numbers>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+// A damped spring between particles a and b. Plain data so a body's springs can be stored flat
+// and streamed through without any branching. In the same precision as the particles.
+template <typename T>
+struct BasicSpring {
+    std::uint32_t a;
+    std::uint32_t b;
+    T             rest; // rest length
+    T             k;    // stiffness
+    T             damp;
+};
+
+using Spring  = BasicSpring<double>;
+using SpringF = BasicSpring<float>;
+
+// applies the damped spring force of s to both of its particles
+template <typename T>
+void springHandler(BasicParticles<T>& ps, const BasicSpring<T>& s) {
+    Vector2<T> diff     = ps.pos[s.a] - ps.pos[s.b]; // broken out alot "yes this is faster!"
+    T          diffMag  = diff.mag();
+    Vector2<T> diffNorm = diff / diffMag;
+    T          ext      = diffMag - s.rest;
+    T          springf  = -s.k * ext;                                        // -ke spring force
+    T          dampf    = diffNorm.dot(ps.vel[s.b] - ps.vel[s.a]) * s.damp; // damping force
+    Vector2<T> force    = (springf + dampf) * diffNorm;
+    ps.f[s.a] += force; // equal and opposite reaction
+    ps.f[s.b] -= force;
+}
+
+template <typename T>
+void springForces(BasicParticles<T>&                                   ps,
+                  std::type_identity_t<std::span<const BasicSpring<T>>> springs) {
+    for (const BasicSpring<T>& s: springs) springHandler(ps, s);
+}
+
+// Builds the springs of a cols x rows grid of particles, stored row major (index = x + y * cols),
+// into springs, re-using its allocation. Each particle links right, down, down-right and
+// down-left, and springs are emitted in order of their first particle so a pass over them walks
+// the particle arrays forwards.
+template <typename T>
+void gridSprings(int cols, int rows, std::type_identity_t<T> gap, std::type_identity_t<T> k,
+                 std::type_identity_t<T> damp, std::vector<BasicSpring<T>>& springs) {
+    springs.clear();
+    if (cols <= 0 || rows <= 0) return;
+    reserveGrowing(springs, static_cast<std::size_t>(4 * cols * rows));
+
+    const T diag = std::numbers::sqrt2_v<T> * gap;
+    auto idx = [cols](int x, int y) { return static_cast<std::uint32_t>(x + y * cols); };
+    for (int y = 0; y < rows; y++) {
+        for (int x = 0; x < cols; x++) {
+            std::uint32_t p = idx(x, y);
+            if (x < cols - 1) springs.push_back({p, idx(x + 1, y), gap, k, damp}); // right
+            if (y < rows - 1) {
+                springs.push_back({p, idx(x, y + 1), gap, k, damp}); // down
+                if (x < cols - 1)
+                    springs.push_back({p, idx(x + 1, y + 1), diag, k, damp}); // down right
+                if (x > 0) springs.push_back({p, idx(x - 1, y + 1), diag, k, damp}); // down left
+            }
+        }
     }
+}
+
+template <typename T = double>
+std::vector<BasicSpring<T>> gridSprings(int cols, int rows, std::type_identity_t<T> gap,
+                                        std::type_identity_t<T> k, std::type_identity_t<T> damp) {
+    std::vector<BasicSpring<T>> springs;
+    gridSprings<T>(cols, rows, gap, k, damp, springs);
+    return springs;
+}
+
+// colourSprings()'s working space, kept to colour again without allocating
+template <typename T>
+struct SpringColouring {
+    std::vector<std::uint64_t>  used; // bit c set: particle has a spring of colour c
+    std::vector<unsigned>       colour;
+    std::vector<std::size_t>    counts;
+    std::vector<std::size_t>    next;
+    std::vector<BasicSpring<T>> sorted; // swapped with the springs, so both buffers live on
 };
+
+// Reorders springs into colour batches in which no two springs share a particle, so each batch
+// can be evaluated by many threads at once without two of them writing the same force. Writes
+// the batch boundaries to starts: batch c is springs[starts[c], starts[c + 1]).
+//
+// Colours are assigned greedily (lowest colour free at both ends) and the reorder is stable, so
+// every batch still walks the particle arrays forwards. For the grid the right, down and
+// diagonal springs end up in a handful of alternating batches.
+template <typename T>
+void colourSprings(std::vector<BasicSpring<T>>& springs, std::size_t particleCount,
+                   std::vector<std::size_t>& starts, SpringColouring<T>& scratch) {
+    scratch.used.assign(particleCount, 0);
+    scratch.colour.resize(springs.size());
+    scratch.counts.clear();
+    for (std::size_t i = 0; i < springs.size(); i++) {
+        const BasicSpring<T>& s    = springs[i];
+        std::uint64_t         free = ~(scratch.used[s.a] | scratch.used[s.b]);
+        if (free == 0) throw std::logic_error("colourSprings: a particle has more than 64 springs");
+        auto c = static_cast<unsigned>(std::countr_zero(free));
+        scratch.used[s.a] |= std::uint64_t{1} << c;
+        scratch.used[s.b] |= std::uint64_t{1} << c;
+        scratch.colour[i] = c;
+        if (c >= scratch.counts.size()) scratch.counts.resize(c + 1);
+        ++scratch.counts[c];
+    }
+
+    starts.assign(scratch.counts.size() + 1, 0);
+    for (std::size_t c = 0; c < scratch.counts.size(); c++)
+        starts[c + 1] = starts[c] + scratch.counts[c];
+
+    reserveGrowing(scratch.sorted, springs.size());
+    scratch.sorted.resize(springs.size());
+    scratch.next.assign(starts.begin(), starts.end() - 1);
+    for (std::size_t i = 0; i < springs.size(); i++)
+        scratch.sorted[scratch.next[scratch.colour[i]]++] = springs[i];
+    springs.swap(scratch.sorted);
+}
+
+template <typename T>
+std::vector<std::size_t> colourSprings(std::vector<BasicSpring<T>>& springs,
+                                       std::size_t                  particleCount) {
+    std::vector<std::size_t> starts;
+    SpringColouring<T>       scratch;
+    colourSprings(springs, particleCount, starts, scratch);
+    return starts;
+}
@@ -0,0 +1,391 @@
+#include "SpringKernel.hpp"
+#include <cmath>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define SOFTBODY_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define SOFTBODY_TARGET_AVX2 // msvc emits any intrinsic without needing a target
+#else
+#define SOFTBODY_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+// the kernels address Vector2 arrays as flat x, y, x, y, ... scalars
+static_assert(sizeof(Vec2) == 2 * sizeof(double));
+static_assert(sizeof(Vec2F) == 2 * sizeof(float));
+
+namespace {
+
+template <typename T>
+T* flat(std::vector<Vector2<T>>& v) {
+    return &v[0].x;
+}
+
+// the per-lane maths of the vector kernels, one spring at a time. Used for the leftover springs
+// which don't fill a vector, and as the reference in tests
+template <typename T>
+void springHandlerSqrt(BasicParticles<T>& ps, const BasicSpring<T>& s) {
+    Vector2<T> diff     = ps.pos[s.a] - ps.pos[s.b];
+    T          diffMag  = std::sqrt(diff.x * diff.x + diff.y * diff.y);
+    Vector2<T> diffNorm = diff / diffMag;
+    T          springf  = -s.k * (diffMag - s.rest);
+    T          dampf    = diffNorm.dot(ps.vel[s.b] - ps.vel[s.a]) * s.damp;
+    Vector2<T> force    = (springf + dampf) * diffNorm;
+    ps.f[s.a] += force;
+    ps.f[s.b] -= force;
+}
+
+template <typename T>
+void integrateScalar(BasicParticles<T>& ps, std::size_t begin, std::size_t end, T dt,
+                     const Vector2<T>& g) {
+    for (std::size_t i = begin; i < end; i++) {
+        ps.vel[i] += (ps.f[i] * ps.invMass[i] + g) * dt;
+        ps.pos[i] += ps.vel[i] * dt;
+        ps.f[i] = Vector2<T>();
+    }
+}
+
+#ifdef SOFTBODY_X86
+
+// forces are scattered lane by lane, in spring order, because neighbouring springs usually share
+// a particle and SSE/AVX2 have no conflict-safe scatter
+template <typename T>
+void scatter(BasicParticles<T>& ps, const BasicSpring<T>* s, const T* fx, const T* fy,
+             int lanes) {
+    for (int l = 0; l < lanes; l++) {
+        Vector2<T> force(fx[l], fy[l]);
+        ps.f[s[l].a] += force;
+        ps.f[s[l].b] -= force;
+    }
+}
+
+void springForcesSse2(Particles& ps, std::span<const Spring> springs) {
+    const double* pos = flat(ps.pos);
+    const double* vel = flat(ps.vel);
+    std::size_t   i   = 0;
+    for (; i + 2 <= springs.size(); i += 2) {
+        const Spring* s = &springs[i];
+        // _mm_set_pd takes lanes high to low
+        const std::size_t a0 = 2 * std::size_t{s[0].a}, a1 = 2 * std::size_t{s[1].a};
+        const std::size_t b0 = 2 * std::size_t{s[0].b}, b1 = 2 * std::size_t{s[1].b};
+
+        __m128d dx  = _mm_sub_pd(_mm_set_pd(pos[a1], pos[a0]), _mm_set_pd(pos[b1], pos[b0]));
+        __m128d dy  = _mm_sub_pd(_mm_set_pd(pos[a1 + 1], pos[a0 + 1]),
+                                 _mm_set_pd(pos[b1 + 1], pos[b0 + 1]));
+        __m128d dvx = _mm_sub_pd(_mm_set_pd(vel[b1], vel[b0]), _mm_set_pd(vel[a1], vel[a0]));
+        __m128d dvy = _mm_sub_pd(_mm_set_pd(vel[b1 + 1], vel[b0 + 1]),
+                                 _mm_set_pd(vel[a1 + 1], vel[a0 + 1]));
+        __m128d rest = _mm_set_pd(s[1].rest, s[0].rest);
+        __m128d k    = _mm_set_pd(-s[1].k, -s[0].k);
+        __m128d damp = _mm_set_pd(s[1].damp, s[0].damp);
+
+        __m128d mag     = _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy)));
+        __m128d nx      = _mm_div_pd(dx, mag);
+        __m128d ny      = _mm_div_pd(dy, mag);
+        __m128d springf = _mm_mul_pd(k, _mm_sub_pd(mag, rest));
+        __m128d dampf = _mm_mul_pd(_mm_add_pd(_mm_mul_pd(nx, dvx), _mm_mul_pd(ny, dvy)), damp);
+        __m128d total = _mm_add_pd(springf, dampf);
+
+        alignas(16) double fx[2];
+        alignas(16) double fy[2];
+        _mm_store_pd(fx, _mm_mul_pd(total, nx));
+        _mm_store_pd(fy, _mm_mul_pd(total, ny));
+        scatter(ps, s, fx, fy, 2);
+    }
+    for (; i < springs.size(); i++) springHandlerSqrt(ps, springs[i]);
+}
+
+SOFTBODY_TARGET_AVX2 void springForcesAvx2(Particles& ps, std::span<const Spring> springs) {
+    const double* pos = flat(ps.pos);
+    const double* vel = flat(ps.vel);
+    std::size_t   i   = 0;
+    for (; i + 4 <= springs.size(); i += 4) {
+        const Spring* s = &springs[i];
+        // hand gathered: vgatherdpd is no faster than scalar loads on most cores
+        const std::size_t a0 = 2 * std::size_t{s[0].a}, a1 = 2 * std::size_t{s[1].a},
+                          a2 = 2 * std::size_t{s[2].a}, a3 = 2 * std::size_t{s[3].a};
+        const std::size_t b0 = 2 * std::size_t{s[0].b}, b1 = 2 * std::size_t{s[1].b},
+                          b2 = 2 * std::size_t{s[2].b}, b3 = 2 * std::size_t{s[3].b};
+
+        __m256d dx = _mm256_sub_pd(_mm256_set_pd(pos[a3], pos[a2], pos[a1], pos[a0]),
+                                   _mm256_set_pd(pos[b3], pos[b2], pos[b1], pos[b0]));
+        __m256d dy = _mm256_sub_pd(
+            _mm256_set_pd(pos[a3 + 1], pos[a2 + 1], pos[a1 + 1], pos[a0 + 1]),
+            _mm256_set_pd(pos[b3 + 1], pos[b2 + 1], pos[b1 + 1], pos[b0 + 1]));
+        __m256d dvx = _mm256_sub_pd(_mm256_set_pd(vel[b3], vel[b2], vel[b1], vel[b0]),
+                                    _mm256_set_pd(vel[a3], vel[a2], vel[a1], vel[a0]));
+        __m256d dvy = _mm256_sub_pd(
+            _mm256_set_pd(vel[b3 + 1], vel[b2 + 1], vel[b1 + 1], vel[b0 + 1]),
+            _mm256_set_pd(vel[a3 + 1], vel[a2 + 1], vel[a1 + 1], vel[a0 + 1]));
+        __m256d rest = _mm256_set_pd(s[3].rest, s[2].rest, s[1].rest, s[0].rest);
+        __m256d k    = _mm256_set_pd(-s[3].k, -s[2].k, -s[1].k, -s[0].k);
+        __m256d damp = _mm256_set_pd(s[3].damp, s[2].damp, s[1].damp, s[0].damp);
+
+        __m256d mag =
+            _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)));
+        __m256d nx      = _mm256_div_pd(dx, mag);
+        __m256d ny      = _mm256_div_pd(dy, mag);
+        __m256d springf = _mm256_mul_pd(k, _mm256_sub_pd(mag, rest));
+        __m256d dampf =
+            _mm256_mul_pd(_mm256_add_pd(_mm256_mul_pd(nx, dvx), _mm256_mul_pd(ny, dvy)), damp);
+        __m256d total = _mm256_add_pd(springf, dampf);
+
+        alignas(32) double fx[4];
+        alignas(32) double fy[4];
+        _mm256_store_pd(fx, _mm256_mul_pd(total, nx));
+        _mm256_store_pd(fy, _mm256_mul_pd(total, ny));
+        scatter(ps, s, fx, fy, 4);
+    }
+    for (; i < springs.size(); i++) springHandlerSqrt(ps, springs[i]);
+}
+
+// pos, vel and f are walked as flat doubles, one particle (x and y) per 2 lanes
+void integrateSse2(Particles& ps, std::size_t begin, std::size_t end, double dt, const Vec2& g) {
+    double*       pos = flat(ps.pos);
+    double*       vel = flat(ps.vel);
+    double*       f   = flat(ps.f);
+    const __m128d vdt = _mm_set1_pd(dt);
+    const __m128d vg  = _mm_set_pd(g.y, g.x);
+    for (std::size_t i = begin; i < end; i++) {
+        __m128d im = _mm_set1_pd(ps.invMass[i]);
+        __m128d a  = _mm_add_pd(_mm_mul_pd(_mm_loadu_pd(f + 2 * i), im), vg);
+        __m128d v  = _mm_add_pd(_mm_loadu_pd(vel + 2 * i), _mm_mul_pd(a, vdt));
+        _mm_storeu_pd(vel + 2 * i, v);
+        _mm_storeu_pd(pos + 2 * i, _mm_add_pd(_mm_loadu_pd(pos + 2 * i), _mm_mul_pd(v, vdt)));
+        _mm_storeu_pd(f + 2 * i, _mm_setzero_pd());
+    }
+}
+
+SOFTBODY_TARGET_AVX2 void integrateAvx2(Particles& ps, std::size_t begin, std::size_t end,
+                                        double dt, const Vec2& g) {
+    double*       pos = flat(ps.pos);
+    double*       vel = flat(ps.vel);
+    double*       f   = flat(ps.f);
+    const __m256d vdt = _mm256_set1_pd(dt);
+    const __m256d vg  = _mm256_set_pd(g.y, g.x, g.y, g.x);
+    std::size_t   i   = begin;
+    for (; i + 2 <= end; i += 2) {
+        const double im0 = ps.invMass[i];
+        const double im1 = ps.invMass[i + 1];
+        __m256d      im  = _mm256_set_pd(im1, im1, im0, im0);
+        __m256d      a   = _mm256_add_pd(_mm256_mul_pd(_mm256_loadu_pd(f + 2 * i), im), vg);
+        __m256d      v   = _mm256_add_pd(_mm256_loadu_pd(vel + 2 * i), _mm256_mul_pd(a, vdt));
+        _mm256_storeu_pd(vel + 2 * i, v);
+        _mm256_storeu_pd(pos + 2 * i,
+                         _mm256_add_pd(_mm256_loadu_pd(pos + 2 * i), _mm256_mul_pd(v, vdt)));
+        _mm256_storeu_pd(f + 2 * i, _mm256_setzero_pd());
+    }
+    integrateScalar(ps, i, end, dt, g);
+}
+
+// Float springs, 4 (SSE) or 8 (AVX2) to a vector. Lane l of these is get(s[l]), gathered one
+// scalar at a time like the double kernels
+template <typename Get>
+__m128 lanes4(const SpringF* s, Get get) {
+    return _mm_set_ps(get(s[3]), get(s[2]), get(s[1]), get(s[0]));
+}
+
+template <typename Get>
+SOFTBODY_TARGET_AVX2 __m256 lanes8(const SpringF* s, Get get) {
+    return _mm256_set_ps(get(s[7]), get(s[6]), get(s[5]), get(s[4]), get(s[3]), get(s[2]),
+                         get(s[1]), get(s[0]));
+}
+
+void springForcesSse2(ParticlesF& ps, std::span<const SpringF> springs) {
+    const Vec2F* pos = ps.pos.data();
+    const Vec2F* vel = ps.vel.data();
+    std::size_t  i   = 0;
+    for (; i + 4 <= springs.size(); i += 4) {
+        const SpringF* s = &springs[i];
+
+        __m128 dx   = _mm_sub_ps(lanes4(s, [&](const SpringF& sp) { return pos[sp.a].x; }),
+                                 lanes4(s, [&](const SpringF& sp) { return pos[sp.b].x; }));
+        __m128 dy   = _mm_sub_ps(lanes4(s, [&](const SpringF& sp) { return pos[sp.a].y; }),
+                                 lanes4(s, [&](const SpringF& sp) { return pos[sp.b].y; }));
+        __m128 dvx  = _mm_sub_ps(lanes4(s, [&](const SpringF& sp) { return vel[sp.b].x; }),
+                                 lanes4(s, [&](const SpringF& sp) { return vel[sp.a].x; }));
+        __m128 dvy  = _mm_sub_ps(lanes4(s, [&](const SpringF& sp) { return vel[sp.b].y; }),
+                                 lanes4(s, [&](const SpringF& sp) { return vel[sp.a].y; }));
+        __m128 rest = lanes4(s, [](const SpringF& sp) { return sp.rest; });
+        __m128 k    = lanes4(s, [](const SpringF& sp) { return -sp.k; });
+        __m128 damp = lanes4(s, [](const SpringF& sp) { return sp.damp; });
+
+        __m128 mag     = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)));
+        __m128 nx      = _mm_div_ps(dx, mag);
+        __m128 ny      = _mm_div_ps(dy, mag);
+        __m128 springf = _mm_mul_ps(k, _mm_sub_ps(mag, rest));
+        __m128 dampf   = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(nx, dvx), _mm_mul_ps(ny, dvy)), damp);
+        __m128 total   = _mm_add_ps(springf, dampf);
+
+        alignas(16) float fx[4];
+        alignas(16) float fy[4];
+        _mm_store_ps(fx, _mm_mul_ps(total, nx));
+        _mm_store_ps(fy, _mm_mul_ps(total, ny));
+        scatter(ps, s, fx, fy, 4);
+    }
+    for (; i < springs.size(); i++) springHandlerSqrt(ps, springs[i]);
+}
+
+SOFTBODY_TARGET_AVX2 void springForcesAvx2(ParticlesF& ps, std::span<const SpringF> springs) {
+    const Vec2F* pos = ps.pos.data();
+    const Vec2F* vel = ps.vel.data();
+    std::size_t  i   = 0;
+    for (; i + 8 <= springs.size(); i += 8) {
+        const SpringF* s = &springs[i];
+
+        __m256 dx   = _mm256_sub_ps(lanes8(s, [&](const SpringF& sp) { return pos[sp.a].x; }),
+                                    lanes8(s, [&](const SpringF& sp) { return pos[sp.b].x; }));
+        __m256 dy   = _mm256_sub_ps(lanes8(s, [&](const SpringF& sp) { return pos[sp.a].y; }),
+                                    lanes8(s, [&](const SpringF& sp) { return pos[sp.b].y; }));
+        __m256 dvx  = _mm256_sub_ps(lanes8(s, [&](const SpringF& sp) { return vel[sp.b].x; }),
+                                    lanes8(s, [&](const SpringF& sp) { return vel[sp.a].x; }));
+        __m256 dvy  = _mm256_sub_ps(lanes8(s, [&](const SpringF& sp) { return vel[sp.b].y; }),
+                                    lanes8(s, [&](const SpringF& sp) { return vel[sp.a].y; }));
+        __m256 rest = lanes8(s, [](const SpringF& sp) { return sp.rest; });
+        __m256 k    = lanes8(s, [](const SpringF& sp) { return -sp.k; });
+        __m256 damp = lanes8(s, [](const SpringF& sp) { return sp.damp; });
+
+        __m256 mag =
+            _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)));
+        __m256 nx      = _mm256_div_ps(dx, mag);
+        __m256 ny      = _mm256_div_ps(dy, mag);
+        __m256 springf = _mm256_mul_ps(k, _mm256_sub_ps(mag, rest));
+        __m256 dampf =
+            _mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(nx, dvx), _mm256_mul_ps(ny, dvy)), damp);
+        __m256 total = _mm256_add_ps(springf, dampf);
+
+        alignas(32) float fx[8];
+        alignas(32) float fy[8];
+        _mm256_store_ps(fx, _mm256_mul_ps(total, nx));
+        _mm256_store_ps(fy, _mm256_mul_ps(total, ny));
+        scatter(ps, s, fx, fy, 8);
+    }
+    for (; i < springs.size(); i++) springHandlerSqrt(ps, springs[i]);
+}
+
+// two particles per SSE vector, four per AVX2 one
+void integrateSse2(ParticlesF& ps, std::size_t begin, std::size_t end, float dt, const Vec2F& g) {
+    float*       pos = flat(ps.pos);
+    float*       vel = flat(ps.vel);
+    float*       f   = flat(ps.f);
+    const __m128 vdt = _mm_set1_ps(dt);
+    const __m128 vg  = _mm_set_ps(g.y, g.x, g.y, g.x);
+    std::size_t  i   = begin;
+    for (; i + 2 <= end; i += 2) {
+        const float im0 = ps.invMass[i];
+        const float im1 = ps.invMass[i + 1];
+        __m128      im  = _mm_set_ps(im1, im1, im0, im0);
+        __m128      a   = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(f + 2 * i), im), vg);
+        __m128      v   = _mm_add_ps(_mm_loadu_ps(vel + 2 * i), _mm_mul_ps(a, vdt));
+        _mm_storeu_ps(vel + 2 * i, v);
+        _mm_storeu_ps(pos + 2 * i, _mm_add_ps(_mm_loadu_ps(pos + 2 * i), _mm_mul_ps(v, vdt)));
+        _mm_storeu_ps(f + 2 * i, _mm_setzero_ps());
+    }
+    integrateScalar(ps, i, end, dt, g);
+}
+
+SOFTBODY_TARGET_AVX2 void integrateAvx2(ParticlesF& ps, std::size_t begin, std::size_t end,
+                                        float dt, const Vec2F& g) {
+    float*       pos = flat(ps.pos);
+    float*       vel = flat(ps.vel);
+    float*       f   = flat(ps.f);
+    const __m256 vdt = _mm256_set1_ps(dt);
+    const __m256 vg  = _mm256_set_ps(g.y, g.x, g.y, g.x, g.y, g.x, g.y, g.x);
+    std::size_t  i   = begin;
+    for (; i + 4 <= end; i += 4) {
+        const float* im = &ps.invMass[i];
+        __m256       m  = _mm256_set_ps(im[3], im[3], im[2], im[2], im[1], im[1], im[0], im[0]);
+        __m256       a  = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(f + 2 * i), m), vg);
+        __m256       v  = _mm256_add_ps(_mm256_loadu_ps(vel + 2 * i), _mm256_mul_ps(a, vdt));
+        _mm256_storeu_ps(vel + 2 * i, v);
+        _mm256_storeu_ps(pos + 2 * i,
+                         _mm256_add_ps(_mm256_loadu_ps(pos + 2 * i), _mm256_mul_ps(v, vdt)));
+        _mm256_storeu_ps(f + 2 * i, _mm256_setzero_ps());
+    }
+    integrateScalar(ps, i, end, dt, g);
+}
+
+#endif // SOFTBODY_X86
+
+} // namespace
+
+Simd detectSimd() {
+#ifdef SOFTBODY_X86
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx     = (info[2] & (1 << 28)) != 0;
+    __cpuidex(info, 7, 0);
+    const bool avx2 = (info[1] & (1 << 5)) != 0;
+    // the OS must also save the upper halves of the ymm registers on a context switch
+    if (osxsave && avx && avx2 && (_xgetbv(0) & 0x6) == 0x6) return Simd::avx2;
+#else
+    if (__builtin_cpu_supports("avx2")) return Simd::avx2;
+#endif
+    return Simd::sse2; // part of the x86-64 baseline
+#else
+    return Simd::scalar;
+#endif
+}
+
+const char* simdName(Simd simd) {
+    switch (simd) {
+    case Simd::scalar: return "scalar";
+    case Simd::sse2: return "SSE2";
+    case Simd::avx2: return "AVX2";
+    }
+    return "unknown";
+}
+
+template <typename T>
+void springForces(BasicParticles<T>&                                   ps,
+                  std::type_identity_t<std::span<const BasicSpring<T>>> springs, Simd simd) {
+    if (ps.empty()) return;
+    switch (simd) {
+#ifdef SOFTBODY_X86
+    case Simd::avx2: springForcesAvx2(ps, springs); return;
+    case Simd::sse2: springForcesSse2(ps, springs); return;
+#endif
+    default: springForces(ps, springs); return;
+    }
+}
+
+template <typename T>
+void springForces(BasicParticles<T>&                                   ps,
+                  std::type_identity_t<std::span<const BasicSpring<T>>> springs,
+                  std::span<const std::size_t> batchStarts, ThreadPool& pool, Simd simd) {
+    for (std::size_t c = 0; c + 1 < batchStarts.size(); c++) {
+        std::span<const BasicSpring<T>> batch =
+            springs.subspan(batchStarts[c], batchStarts[c + 1] - batchStarts[c]);
+        pool.parallelFor(batch.size(), [&](std::size_t begin, std::size_t end) {
+            springForces(ps, batch.subspan(begin, end - begin), simd);
+        });
+    }
+}
+
+template <typename T>
+void integrate(BasicParticles<T>& ps, std::size_t begin, std::size_t end,
+               std::type_identity_t<T> dt, const Vector2<T>& g, Simd simd) {
+    if (begin >= end) return;
+    switch (simd) {
+#ifdef SOFTBODY_X86
+    case Simd::avx2: integrateAvx2(ps, begin, end, dt, g); return;
+    case Simd::sse2: integrateSse2(ps, begin, end, dt, g); return;
+#endif
+    default: integrateScalar(ps, begin, end, dt, g); return;
+    }
+}
+
+// the two precisions the kernels are built for
+template void springForces<double>(Particles&, std::span<const Spring>, Simd);
+template void springForces<float>(ParticlesF&, std::span<const SpringF>, Simd);
+template void springForces<double>(Particles&, std::span<const Spring>,
+                                   std::span<const std::size_t>, ThreadPool&, Simd);
+template void springForces<float>(ParticlesF&, std::span<const SpringF>,
+                                  std::span<const std::size_t>, ThreadPool&, Simd);
+template void integrate<double>(Particles&, std::size_t, std::size_t, double, const Vec2&, Simd);
+template void integrate<float>(ParticlesF&, std::size_t, std::size_t, float, const Vec2F&, Simd);
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "Particles.hpp"
+#include "Spring.hpp"
+#include "ThreadPool.hpp"
+#include "Vector2.hpp"
+#include <cstddef>
+#include <span>
+#include <type_traits>
+
+// Explicitly vectorised spring and integration passes, chosen at runtime from what the CPU
+// supports. In double that is 2 (SSE2) or 4 (AVX2) springs or coordinates per instruction, and in
+// float twice as many. Both precisions are compiled, see SpringKernel.cpp.
+//
+// The vector spring kernel uses sqrt(dx*dx + dy*dy) where springHandler() uses std::hypot, so it
+// agrees with the scalar path to within rounding rather than exactly. The leftover springs which
+// don't fill a vector use the same formula, so for a given Simd level the result does not depend
+// on how the springs are chunked across threads. Integration is bit identical at every level.
+enum class Simd { scalar, sse2, avx2 };
+
+// best level supported by this CPU (and OS, for AVX register state)
+Simd detectSimd();
+
+const char* simdName(Simd simd);
+
+template <typename T>
+void springForces(BasicParticles<T>&                                   ps,
+                  std::type_identity_t<std::span<const BasicSpring<T>>> springs, Simd simd);
+
+// colour batched, multithreaded version: see colourSprings()
+template <typename T>
+void springForces(BasicParticles<T>&                                   ps,
+                  std::type_identity_t<std::span<const BasicSpring<T>>> springs,
+                  std::span<const std::size_t> batchStarts, ThreadPool& pool, Simd simd);
+
+// semi-implicit euler step of particles [begin, end) under forces f plus acceleration g, then
+// clears f ready for the next step
+template <typename T>
+void integrate(BasicParticles<T>& ps, std::size_t begin, std::size_t end,
+               std::type_identity_t<T> dt, const Vector2<T>& g, Simd simd);
@@ -0,0 +1,203 @@
+#pragma once
+
+#include "Checkpoint.hpp"
+#include "Integrator.hpp"
+#include "Particles.hpp"
+#include "Polygon.hpp"
+#include "SoftBody.hpp"
+#include "Spring.hpp"
+#include "ThreadPool.hpp"
+#include "Vector2.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <span>
+#include <vector>
+
+// true while the body is still in one piece: every position and velocity is finite and nothing
+// moves faster than maxSpeed. An unstable explicit scheme blows through that within a few steps.
+template <typename T>
+bool isStable(const BasicParticles<T>& ps, double maxSpeed = 100) {
+    for (std::size_t i = 0; i < ps.size(); i++) {
+        if (!std::isfinite(ps.pos[i].x) || !std::isfinite(ps.pos[i].y)) return false;
+        if (!(ps.vel[i].mag() < maxSpeed)) return false; // also catches nan
+    }
+    return true;
+}
+
+// does a copy of body stay stable for simTime seconds of steps of dt
+template <typename T>
+bool stableAt(const BasicSoftBody<T>& body, const std::vector<Polygon>& polys, double gravity,
+              double dt, double simTime, ThreadPool* pool) {
+    BasicSoftBody<T> sb    = body;
+    const auto       steps = static_cast<long>(simTime / dt);
+    for (long i = 0; i < steps; i++) {
+        sb.simFrame(dt, gravity, polys, pool);
+        if (i % 64 == 0 && !isStable(sb.getPoints())) return false; // give up early
+    }
+    return isStable(sb.getPoints());
+}
+
+// Largest timestep, to within 2%, at which body (with its current integrator and springs) stays
+// stable for simTime seconds in the given scene. Doubles from minDt until it breaks, then
+// bisects. Returns 0 if even minDt is unstable.
+template <typename T>
+double largestStableDt(const BasicSoftBody<T>& body, const std::vector<Polygon>& polys,
+                       double gravity, double simTime = 1.0, ThreadPool* pool = nullptr,
+                       double minDt = 1e-4, double maxDt = 0.1) {
+    if (!stableAt(body, polys, gravity, minDt, simTime, pool)) return 0;
+    double good = minDt;
+    double bad  = good * 2;
+    while (bad <= maxDt && stableAt(body, polys, gravity, bad, simTime, pool)) {
+        good = bad;
+        bad *= 2;
+    }
+    if (bad > maxDt) return good;
+    while (bad / good > 1.02) {
+        double mid = std::sqrt(good * bad); // bisect in log space
+        if (stableAt(body, polys, gravity, mid, simTime, pool))
+            good = mid;
+        else
+            bad = mid;
+    }
+    return good;
+}
+
+// Chooses each step's dt as the largest the body can take: below an analytic stability bound
+// for its springs and masses, and optionally below the step at which an error estimate stays
+// within tolerance. Far cheaper than largestStableDt(), which finds the bound by simulating.
+//
+// The bound comes from Gershgorin discs. Per point, the springs' stiffness (and separately
+// their damping) summed as k (1 / m + 1 / sqrt(m m')) over every spring it has, m' the mass at
+// the other end, caps the square of the fastest frequency w2 (and the fastest decay g) the body
+// can have, so the stiffest spring on the lightest point sets it. Symplectic Euler on
+// x'' = -w2 x - g x' is stable for dt < 4 / (g + sqrt(g^2 + 4 w2)), which is 2 / sqrt(w2)
+// undamped. The directions of the springs are ignored, so this is safe for any shape the body
+// takes, but cautious: about half the largest stable dt that largestStableDt() finds for the
+// default body, for any stiffness and damping. With self collision, each point also counts the
+// penalty contacts it could be in at once, as springs of the contact stiffness to the lightest
+// point, since which points touch changes from step to step.
+//
+// The error estimate is embedded in the step: symplectic Euler moves each point by dt v', the
+// trapezoidal rule by dt (v + v') / 2 from the same forces, so half dt |v' - v| estimates the
+// local position error for nothing more than a copy of the velocities.
+template <typename T>
+class BasicDtController {
+  public:
+    bool   enabled   = false;
+    double minDt     = 1e-5; // however small the bound or error ask for
+    double maxDt     = 5e-3; // also the step of the unconditionally stable integrators
+    double safety    = 1.0;  // the fraction of the stability bound to take
+    double tolerance = 0;    // most position error per step, 0 for the stability bound alone
+
+    // Re-derives the stability bound from body's springs, masses and integrator. Call after
+    // changing any of them
+    void update(const BasicSoftBody<T>& body) {
+        const T contactK    = body.selfCollision ? body.springConst : T(0);
+        const T contactDamp = body.selfCollision ? body.dampFact : T(0);
+        stableBound         = stabilityBound(body.getPoints(), body.getSprings(), body.integrator,
+                                             contactK, contactDamp);
+    }
+
+    // the largest stable dt as of the last update(), infinite if there is none
+    [[nodiscard]] double bound() const { return stableBound; }
+    // of the last step measured, in the same units as positions
+    [[nodiscard]] double error() const { return lastError; }
+
+    // the step to take next
+    [[nodiscard]] double dt() const {
+        double h = std::min(safety * stableBound, maxDt);
+        if (tolerance > 0) h = std::min(h, errorDt);
+        return std::clamp(h, minDt, std::max(minDt, maxDt));
+    }
+
+    // Around every step when tolerance is set, to estimate its error and so the next dt
+    void beforeStep(const BasicParticles<T>& ps) {
+        if (tolerance > 0) vel.assign(ps.vel.begin(), ps.vel.end());
+    }
+    void afterStep(const BasicParticles<T>& ps, double h) {
+        if (tolerance <= 0 || vel.size() != ps.size()) return;
+        T most = 0;
+        for (std::size_t i = 0; i < ps.size(); i++) {
+            const Vector2<T> dv = ps.vel[i] - vel[i];
+            most                = std::max(most, dv.dot(dv));
+        }
+        lastError = h * std::sqrt(static_cast<double>(most)) / 2;
+        // first order, so the error goes as dt^2. Grows or shrinks at most twofold a step, and
+        // aims a little under tolerance so it isn't forever just over
+        const double scale = lastError > 0 ? 0.9 * std::sqrt(tolerance / lastError) : 2.0;
+        errorDt            = h * std::clamp(scale, 0.5, 2.0);
+    }
+
+    // The settings and the step the error asks for, enough to carry on exactly. Not the bound,
+    // which update() re-derives from the restored body
+    void save(CheckpointWriter& out) const {
+        out.put(enabled);
+        out.put(minDt);
+        out.put(maxDt);
+        out.put(safety);
+        out.put(tolerance);
+        out.put(errorDt);
+        out.put(lastError);
+    }
+    void restore(CheckpointReader& in) {
+        in.get(enabled);
+        in.get(minDt);
+        in.get(maxDt);
+        in.get(safety);
+        in.get(tolerance);
+        in.get(errorDt);
+        in.get(lastError);
+        vel.clear();
+    }
+
+    // The stability bound for integrator with these points and springs, as above. contactK and
+    // contactDamp are those of the contacts between points, 0 without self collision
+    double stabilityBound(const BasicParticles<T>& ps, std::span<const BasicSpring<T>> springs,
+                          Integrator integrator, T contactK = 0, T contactDamp = 0) {
+        if (integrator == Integrator::implicitEuler || integrator == Integrator::xpbd)
+            return std::numeric_limits<double>::infinity();
+        stiffness.assign(ps.size(), 0);
+        damping.assign(ps.size(), 0);
+        if (!ps.empty() && (contactK > 0 || contactDamp > 0)) {
+            // 1 / the mass of the lightest point
+            const double lightest = static_cast<double>(std::ranges::max(ps.invMass));
+            for (std::size_t i = 0; i < ps.size(); i++) {
+                const double a     = static_cast<double>(ps.invMass[i]);
+                const double share = contactsPerPoint * (a + std::sqrt(a * lightest));
+                stiffness[i]       = static_cast<double>(contactK) * share;
+                damping[i]         = static_cast<double>(contactDamp) * share;
+            }
+        }
+        for (const BasicSpring<T>& s: springs) {
+            const double a     = static_cast<double>(ps.invMass[s.a]);
+            const double b     = static_cast<double>(ps.invMass[s.b]);
+            const double cross = std::sqrt(a * b);
+            stiffness[s.a] += static_cast<double>(s.k) * (a + cross);
+            stiffness[s.b] += static_cast<double>(s.k) * (b + cross);
+            damping[s.a] += static_cast<double>(s.damp) * (a + cross);
+            damping[s.b] += static_cast<double>(s.damp) * (b + cross);
+        }
+        const double w2 = stiffness.empty() ? 0 : *std::ranges::max_element(stiffness);
+        const double g  = damping.empty() ? 0 : *std::ranges::max_element(damping);
+        if (w2 <= 0 && g <= 0) return std::numeric_limits<double>::infinity();
+        const double h = 4 / (g + std::sqrt(g * g + 4 * w2));
+        // verlet matches symplectic euler. rk4's region reaches about 2.8 / w along both axes
+        // rather than 2 / w, of which this takes a cautious part
+        return integrator == Integrator::rk4 ? 1.3 * h : h;
+    }
+
+  private:
+    // the most points of one size that can touch another without overlapping each other
+    static constexpr double contactsPerPoint = 6;
+
+    double                  stableBound = std::numeric_limits<double>::infinity();
+    double                  errorDt     = std::numeric_limits<double>::infinity();
+    double                  lastError   = 0;
+    std::vector<Vector2<T>> vel;       // before the step
+    std::vector<double>     stiffness; // stabilityBound()'s row sums, kept to re-use
+    std::vector<double>     damping;
+};
+
+using DtController = BasicDtController<double>;
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+
+// Fixed timestep scheduler. Real elapsed time is fed into an accumulator which is drained in
+// whole steps of exactly `dt`, so the physics never sees timer jitter and two runs of the same
+// scene take the same steps. The remainder is reported as alpha() for interpolating what is drawn.
+class FixedStepper {
+  public:
+    double dt;          // seconds of simulated time per step
+    int    maxSubsteps; // cap on catch-up steps per advance()
+
+    explicit FixedStepper(double dt_ = 1e-4, int maxSubsteps_ = 100)
+        : dt(dt_), maxSubsteps(maxSubsteps_) {}
+
+    // Adds `elapsed` seconds of real time and returns how many steps to take now. If that would be
+    // more than maxSubsteps, the backlog beyond it is dropped and the simulation runs slower than
+    // real time instead of spiralling ever further behind.
+    int advance(double elapsed) {
+        accumulator_ += elapsed;
+        int steps = static_cast<int>(accumulator_ / dt);
+        if (steps > maxSubsteps) {
+            steps        = maxSubsteps;
+            accumulator_ = std::fmod(accumulator_, dt); // keep the phase, for alpha()
+        } else {
+            accumulator_ -= steps * dt;
+        }
+        return steps;
+    }
+
+    // how far, as a fraction of dt, real time is past the last step taken
+    [[nodiscard]] double alpha() const { return std::clamp(accumulator_ / dt, 0.0, 1.0); }
+
+    void reset() { accumulator_ = 0; }
+
+  private:
+    double accumulator_ = 0;
+};
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "Trace.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Fixed set of worker threads for fork-join loops which run thousands of times per second.
+// Workers sleep on an atomic generation counter (futex backed, so no mutex or condition variable
+// round trip per job) and the calling thread always runs a share of the work itself.
+class ThreadPool {
+  public:
+    // `threads` counts the calling thread, so ThreadPool(1) starts no workers at all
+    explicit ThreadPool(unsigned threads = std::thread::hardware_concurrency()) {
+        threads = std::max(threads, 1U);
+        workers_.reserve(threads - 1);
+        for (unsigned i = 1; i < threads; i++) workers_.emplace_back([this, i] { work(i); });
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool() {
+        stop_ = true;
+        generation_.fetch_add(1, std::memory_order_release);
+        generation_.notify_all();
+        for (std::thread& t: workers_) t.join();
+    }
+
+    [[nodiscard]] unsigned size() const { return static_cast<unsigned>(workers_.size()) + 1; }
+
+    // Calls fn(begin, end) on size() contiguous chunks covering [0, n) and returns once all of
+    // them are done. Chunk boundaries depend only on n and size(). Ranges smaller than
+    // `minChunk` per thread are run inline on the calling thread.
+    template <typename Fn>
+    void parallelFor(std::size_t n, Fn&& fn, std::size_t minChunk = 256) {
+        if (workers_.empty() || n < 2 * minChunk) {
+            fn(std::size_t{0}, n);
+            return;
+        }
+        ctx_  = &fn;
+        call_ = [](void* ctx, std::size_t begin, std::size_t end) {
+            (*static_cast<std::remove_reference_t<Fn>*>(ctx))(begin, end);
+        };
+        n_ = n;
+        pending_.store(static_cast<unsigned>(workers_.size()), std::memory_order_relaxed);
+        generation_.fetch_add(1, std::memory_order_release);
+        generation_.notify_all();
+
+        runChunk(0);
+
+        unsigned left = pending_.load(std::memory_order_acquire);
+        while (left != 0) {
+            pending_.wait(left, std::memory_order_acquire);
+            left = pending_.load(std::memory_order_acquire);
+        }
+    }
+
+  private:
+    std::vector<std::thread> workers_;
+    std::atomic<unsigned>    generation_{0};
+    std::atomic<unsigned>    pending_{0};
+    std::atomic<bool>        stop_{false};
+
+    // the current job, published by the release increment of generation_
+    void* ctx_                                      = nullptr;
+    void (*call_)(void*, std::size_t, std::size_t) = nullptr;
+    std::size_t n_                                  = 0;
+
+    void runChunk(unsigned chunk) const {
+        const std::size_t threads = size();
+        std::size_t       begin   = n_ * chunk / threads;
+        std::size_t       end     = n_ * (chunk + 1) / threads;
+        if (begin == end) return;
+        SOFTBODY_TRACE("Chunk");
+        call_(ctx_, begin, end);
+    }
+
+    void work(unsigned chunk) {
+        nameTraceThread("Worker " + std::to_string(chunk));
+        unsigned seen = 0;
+        for (;;) {
+            generation_.wait(seen, std::memory_order_acquire);
+            seen = generation_.load(std::memory_order_acquire);
+            if (stop_) return;
+            runChunk(chunk);
+            if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) pending_.notify_one();
+        }
+    }
+};
+
+// pool->parallelFor(n, fn), or just fn(0, n) on this thread when there is no pool
+template <typename Fn>
+void parallelFor(ThreadPool* pool, std::size_t n, Fn&& fn, std::size_t minChunk = 256) {
+    if (pool != nullptr)
+        pool->parallelFor(n, std::forward<Fn>(fn), minChunk);
+    else
+        fn(std::size_t{0}, n);
+}
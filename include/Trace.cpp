@@ -0,0 +1,116 @@
+#include "Trace.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+std::atomic<std::uint64_t> nextTracerId{1}; // 0 is no tracer, in the thread caches
+
+thread_local std::string traceThreadName;
+
+// as a JSON string, quotes and all
+void writeString(std::ostream& out, const std::string& s) {
+    out << '"';
+    for (char c: s) {
+        if (c == '"' || c == '\\') out << '\\';
+        if (static_cast<unsigned char>(c) >= 0x20) out << c;
+    }
+    out << '"';
+}
+
+// Chrome traces count in microseconds, fractions allowed
+double micros(std::int64_t ticks) {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::duration(ticks))
+        .count();
+}
+
+} // namespace
+
+void nameTraceThread(std::string name) { traceThreadName = std::move(name); }
+
+Tracer::Tracer(std::size_t eventsPerThread)
+    : id(nextTracerId.fetch_add(1, std::memory_order_relaxed)),
+      capacity(std::max(eventsPerThread, std::size_t{1})) {}
+
+Tracer::~Tracer() { stop(); }
+
+void Tracer::start() { activeTracer.store(this, std::memory_order_release); }
+
+void Tracer::stop() {
+    Tracer* self = this;
+    activeTracer.compare_exchange_strong(self, nullptr, std::memory_order_acq_rel);
+}
+
+std::size_t Tracer::threads() const {
+    const std::lock_guard lock(ringsMutex);
+    return rings.size();
+}
+
+Tracer::Ring& Tracer::addThread() {
+    auto r    = std::make_unique<Ring>();
+    r->events = std::vector<Event>(capacity + 1); // the spare is the one being written
+    const std::lock_guard lock(ringsMutex);
+    r->tid        = static_cast<std::uint32_t>(rings.size() + 1);
+    r->threadName = traceThreadName.empty() ? "Thread " + std::to_string(r->tid)
+                                            : traceThreadName;
+    return *rings.emplace_back(std::move(r));
+}
+
+void Tracer::write(std::ostream& out) const {
+    const std::lock_guard lock(ringsMutex);
+    out << R"({"displayTimeUnit":"ns","traceEvents":[)";
+    out << std::fixed << std::setprecision(3);
+    bool first = true;
+    auto comma = [&] {
+        if (!first) out << ",\n";
+        first = false;
+    };
+    struct Copy {
+        const char*  name;
+        std::int64_t start;
+        std::int64_t duration;
+    };
+    std::vector<Copy> copies;
+    for (const std::unique_ptr<Ring>& r: rings) {
+        comma();
+        out << R"({"name":"thread_name","ph":"M","pid":1,"tid":)" << r->tid
+            << R"(,"args":{"name":)";
+        writeString(out, r->threadName);
+        out << "}}";
+
+        // copy, then keep only what the thread can't have been overwriting meanwhile: the event
+        // it is writing now lands on the oldest
+        const std::size_t   n      = r->events.size();
+        const std::uint64_t before = r->written.load(std::memory_order_acquire);
+        const std::uint64_t from   = before > n ? before - n : 0;
+        copies.clear();
+        for (std::uint64_t i = from; i < before; i++) {
+            const Event& e = r->events[i % n];
+            copies.push_back({e.name.load(std::memory_order_relaxed),
+                              e.start.load(std::memory_order_relaxed),
+                              e.duration.load(std::memory_order_relaxed)});
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const std::uint64_t after = r->written.load(std::memory_order_relaxed);
+        const std::uint64_t valid = after + 1 > n ? after + 1 - n : 0;
+        for (std::uint64_t i = std::max(from, valid); i < before; i++) {
+            const Copy& c = copies[i - from];
+            comma();
+            out << R"({"name":)";
+            writeString(out, c.name);
+            out << R"(,"ph":"X","pid":1,"tid":)" << r->tid << R"(,"ts":)" << micros(c.start)
+                << R"(,"dur":)" << micros(c.duration) << '}';
+        }
+    }
+    out << "]}\n";
+}
+
+void Tracer::save(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file) throw std::runtime_error("trace: could not write " + path);
+    write(file);
+    if (!file) throw std::runtime_error("trace: could not write " + path);
+}
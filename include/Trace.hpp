@@ -0,0 +1,129 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// A timeline of what every thread was doing, for finding stalls and jitter that averages hide,
+// saved as Chrome trace JSON to open in chrome://tracing or https://ui.perfetto.dev.
+//
+// While a Tracer is active, every SOFTBODY_TIME() phase (see Profiler.hpp) and SOFTBODY_TRACE()
+// scope on any thread becomes one event. Each thread writes to its own ring of the most recent
+// events, allocated the first time it records and never again, so recording is a few relaxed
+// stores and a release. The oldest events are overwritten once a ring is full. Built without
+// SOFTBODY_PROFILE, neither macro records anything.
+class Tracer {
+  public:
+    // eventsPerThread: the length of each thread's ring, 24 bytes an event
+    explicit Tracer(std::size_t eventsPerThread = std::size_t{1} << 16);
+
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+
+    ~Tracer(); // stops it, if active
+
+    // Makes this the tracer every thread records into, in place of any other. It must outlive
+    // every thread which might still be recording into it, so stop() it and join them first
+    void start();
+    void stop();
+    [[nodiscard]] bool active() const { return current() == this; }
+
+    // the active tracer, or nullptr
+    static Tracer* current() { return activeTracer.load(std::memory_order_acquire); }
+
+    // One complete event on the calling thread. name must outlive the tracer, a literal say
+    void record(const char* name, std::chrono::steady_clock::time_point start,
+                std::chrono::steady_clock::time_point end) {
+        Ring&               r = ring();
+        const std::uint64_t i = r.written.load(std::memory_order_relaxed);
+        Event&              e = r.events[i % r.events.size()];
+        // so a reader which sees any of this event has seen `written` reach i, and knows the
+        // event it overwrites is going
+        std::atomic_thread_fence(std::memory_order_release);
+        e.name.store(name, std::memory_order_relaxed);
+        e.start.store((start - epoch).count(), std::memory_order_relaxed);
+        e.duration.store((end - start).count(), std::memory_order_relaxed);
+        r.written.store(i + 1, std::memory_order_release);
+    }
+
+    // Every thread's events so far as Chrome trace JSON. Safe while threads are still recording:
+    // events overwritten during the copy are left out rather than torn
+    void write(std::ostream& out) const;
+    // the same into path. Throws std::runtime_error if it can't be written
+    void save(const std::string& path) const;
+
+    [[nodiscard]] std::size_t threads() const;
+
+  private:
+    struct Event {
+        std::atomic<const char*>  name{nullptr};
+        std::atomic<std::int64_t> start{0};    // steady clock ticks since epoch
+        std::atomic<std::int64_t> duration{0}; // in ticks
+    };
+
+    struct Ring {
+        std::vector<Event>         events;
+        std::atomic<std::uint64_t> written{0}; // ever, the next goes at written % size
+        std::uint32_t              tid;
+        std::string                threadName;
+    };
+
+    std::uint64_t                         id; // tells tracers apart in each thread's cache
+    std::size_t                           capacity;
+    std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+    mutable std::mutex                    ringsMutex; // only taken to add a thread, or to write
+    std::vector<std::unique_ptr<Ring>>    rings;
+
+    static inline std::atomic<Tracer*> activeTracer{nullptr};
+
+    Ring& ring() {
+        thread_local Ring*         cached   = nullptr;
+        thread_local std::uint64_t cachedId = 0;
+        if (cachedId != id) {
+            cached   = &addThread();
+            cachedId = id;
+        }
+        return *cached;
+    }
+
+    Ring& addThread();
+};
+
+// Names the calling thread in traces, for threads which record from now on
+void nameTraceThread(std::string name);
+
+// Records its scope as an event named name, if a tracer is active. Use through SOFTBODY_TRACE(),
+// which compiles out
+class TraceScope {
+  public:
+    explicit TraceScope(const char* name_) : tracer(Tracer::current()), name(name_) {
+        if (tracer != nullptr) start = std::chrono::steady_clock::now();
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+    ~TraceScope() {
+        if (tracer != nullptr) tracer->record(name, start, std::chrono::steady_clock::now());
+    }
+
+  private:
+    Tracer*                               tracer;
+    const char*                           name;
+    std::chrono::steady_clock::time_point start;
+};
+
+// traces the rest of the enclosing scope under name, a string literal
+#ifdef SOFTBODY_PROFILE
+#define SOFTBODY_TRACE_NAME2(line) traceScope##line
+#define SOFTBODY_TRACE_NAME(line)  SOFTBODY_TRACE_NAME2(line)
+#define SOFTBODY_TRACE(name)       const TraceScope SOFTBODY_TRACE_NAME(__LINE__)(name)
+#else
+#define SOFTBODY_TRACE(name) static_cast<void>(0)
+#endif
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+#include <utility>
+
+// Lock-free single producer, single consumer hand over of the latest value. The writer fills
+// back() and publish()es it, the reader calls update() and reads front(). Neither side ever
+// waits: the third buffer sits in the middle, holding the most recently published value until
+// the reader swaps it out, or the writer replaces it with a newer one.
+template <typename T>
+class TripleBuffer {
+  public:
+    TripleBuffer() = default;
+
+    // writer side
+    T& back() { return buffers_[back_]; }
+
+    void publish() {
+        unsigned old = middle_.exchange(back_ | freshBit, std::memory_order_acq_rel);
+        back_        = old & indexMask;
+    }
+
+    // true while the last published value has not been picked up by the reader
+    [[nodiscard]] bool pending() const {
+        return (middle_.load(std::memory_order_acquire) & freshBit) != 0;
+    }
+
+    // reader side: swaps in the latest published value, if there is one since the last call
+    bool update() {
+        if ((middle_.load(std::memory_order_relaxed) & freshBit) == 0) return false;
+        unsigned old = middle_.exchange(front_, std::memory_order_acq_rel);
+        front_       = old & indexMask;
+        return true;
+    }
+
+    const T& front() const { return buffers_[front_]; }
+
+  private:
+    static constexpr unsigned freshBit  = 4;
+    static constexpr unsigned indexMask = 3;
+
+    T                     buffers_[3]{};
+    unsigned              back_ = 0;   // owned by the writer
+    std::atomic<unsigned> middle_{1};  // index, plus freshBit if not yet read
+    unsigned              front_ = 2;  // owned by the reader
+};
@@ -13,24 +13,29 @@ class Vector2 {
 
     constexpr Vector2() = default;
 
+    // between precisions, eg a float body's positions against double polygons
+    template <typename U>
+    constexpr explicit Vector2(const Vector2<U>& v)
+        : x(static_cast<T>(v.x)), y(static_cast<T>(v.y)) {}
+
     T       mag() const { return std::hypot(x, y); }
     Vector2 norm() const { return *this / this->mag(); }
-    double  dot(const Vector2& rhs) const { return x * rhs.x + y * rhs.y; }
+    T       dot(const Vector2& rhs) const { return x * rhs.x + y * rhs.y; }
 
     // clang-format off
     Vector2& operator+=(const Vector2& obj) { x += obj.x; y += obj.y; return *this; }
     Vector2& operator-=(const Vector2& obj) { x -= obj.x; y -= obj.y; return *this; }
-    Vector2& operator*=(double scale) { x *= scale; y *= scale; return *this; }
-    Vector2& operator/=(double scale) { x /= scale; y /= scale; return *this; }
+    Vector2& operator*=(T scale) { x *= scale; y *= scale; return *this; }
+    Vector2& operator/=(T scale) { x /= scale; y /= scale; return *this; }
     // clang-format on
 
     bool operator==(const Vector2& rhs) const = default;
     
     friend Vector2 operator+(Vector2 lhs, const Vector2& rhs) { return lhs += rhs; }
     friend Vector2 operator-(Vector2 lhs, const Vector2& rhs) { return lhs -= rhs; }
-    friend Vector2 operator*(Vector2 lhs, double scale) { return lhs *= scale; }
-    friend Vector2 operator*(double scale, Vector2 rhs) { return rhs *= scale; }
-    friend Vector2 operator/(Vector2 lhs, double scale) { return lhs /= scale; }
+    friend Vector2 operator*(Vector2 lhs, T scale) { return lhs *= scale; }
+    friend Vector2 operator*(T scale, Vector2 rhs) { return rhs *= scale; }
+    friend Vector2 operator/(Vector2 lhs, T scale) { return lhs /= scale; }
 
     friend std::ostream& operator<<(std::ostream& os, const Vector2& v) {
         return os << '[' << v.x << ", " << v.y << ']';
@@ -38,5 +43,6 @@ class Vector2 {
 };
 
 using Vec2  = Vector2<double>;
+using Vec2F = Vector2<float>;
 using Vec2I = Vector2<int>;
 using Vec2U = Vector2<unsigned>;
@@ -0,0 +1,280 @@
+#pragma once
+
+#include "Broadphase.hpp"
+#include "CellList.hpp"
+#include "Integrator.hpp"
+#include "Particles.hpp"
+#include "Polygon.hpp"
+#include "Sleep.hpp"
+#include "SoftBody.hpp"
+#include "Spring.hpp"
+#include "SpringKernel.hpp"
+#include "ThreadPool.hpp"
+#include "Vector2.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+// Many soft bodies and the static polygons they land on, stepped together with one gravity and
+// dt. Every body's particles live in one shared pool and every spring in one shared list, each
+// body being just a range of both, so a scene of a thousand bodies is a handful of flat arrays:
+// no allocation per body and nothing virtual to call.
+//
+// A step is the same phases as SoftBody::simFrame(). The springs are evaluated a body at a time,
+// with whole bodies shared out between the pool's threads: a body's springs only touch its own
+// particles, so independent bodies never wait on each other. Contact, both within a body and
+// between bodies, is one cell list over the whole pool, and integration and the polygons go
+// particle by particle. None of it depends on the pool size, so the result doesn't either.
+//
+// Within a body points are solid to their radius, as in SoftBody. Between bodies that would let
+// a point slip through the gaps of another body's grid, so there each body's points are solid
+// to half its shortest spring instead: two bodies touch when their outer rows come within about
+// one gap of each other, whatever the radius.
+//
+// With `sleeping` on, each body has its own rest detection (see Sleep.hpp) and a body at rest
+// stops being simulated: its springs, integration and polygons are all skipped, though it is
+// still solid to the others. It wakes when an awake point moving faster than it would sleep at
+// touches it, or on wake(), so a body settling onto one asleep doesn't keep it awake. Once every
+// body sleeps a step costs next to nothing. Only with symplectic Euler, the others step the whole
+// pool at once, so with them bodies never sleep: switching to one, or turning `sleeping` off,
+// wakes every body on the next step.
+//
+// T is the precision of the pool, as for BasicSoftBody.
+template <typename T>
+class BasicWorld {
+  public:
+    struct Body {
+        std::uint32_t firstPoint;
+        std::uint32_t pointCount;
+        std::uint32_t firstSpring;
+        std::uint32_t springCount;
+    };
+
+    std::vector<Polygon> polys; // call rebuildPolygons() after moving or changing them
+    double               gravity          = 2.0;
+    double               dt               = 1e-4;
+    Simd                 simd             = detectSimd();
+    Integrator           integrator       = Integrator::symplecticEuler; // a force based one
+    bool                 contacts         = true; // between points, in the same body or not
+    T                    contactStiffness = 8000;
+    T                    contactDamping   = 100;
+    bool                 sleeping         = false; // bodies at rest stop being simulated
+
+    void reserve(std::size_t bodyCount, std::size_t pointCount, std::size_t springCount) {
+        bodies.reserve(bodyCount);
+        sleepers.reserve(bodyCount);
+        shells.reserve(bodyCount);
+        points.reserve(pointCount);
+        owner.reserve(pointCount);
+        springs.reserve(springCount);
+    }
+
+    // Copies body's particles and springs into the world, which simulates them from then on
+    // with its own settings rather than body's, except for the sleep thresholds. Returns the new
+    // body's index.
+    std::size_t add(const BasicSoftBody<T>& body) {
+        const BasicParticles<T>&        ps     = body.getPoints();
+        std::span<const BasicSpring<T>> ss     = body.getSprings();
+        const auto                      offset = static_cast<std::uint32_t>(points.size());
+        bodies.push_back({offset, static_cast<std::uint32_t>(ps.size()),
+                          static_cast<std::uint32_t>(springs.size()),
+                          static_cast<std::uint32_t>(ss.size())});
+        T shell = 0;
+        for (std::size_t i = 0; i < ps.size(); i++) {
+            const std::size_t p = points.add(ps.pos[i], ps.mass(i), ps.radius[i]);
+            points.vel[p]       = ps.vel[i];
+            points.invMass[p]   = ps.invMass[i]; // exactly, 1 / (1 / m) might not round trip
+            shell               = std::max(shell, ps.radius[i]);
+            owner.push_back(static_cast<std::uint32_t>(bodies.size() - 1));
+        }
+        maxRadius = std::max(maxRadius, shell);
+        if (!ss.empty()) {
+            const auto shortest = std::ranges::min(ss, {}, &BasicSpring<T>::rest).rest;
+            shell               = std::max(shell, shortest / 2);
+        }
+        shells.push_back(shell);
+        maxShell = std::max(maxShell, shell);
+        for (BasicSpring<T> s: ss) {
+            s.a += offset;
+            s.b += offset;
+            springs.push_back(s);
+        }
+        BasicSleeper<T>& sleeper = sleepers.emplace_back(body.sleeper);
+        sleeper.enabled          = true; // whether it is used is up to `sleeping`
+        sleeper.wake();
+        return bodies.size() - 1;
+    }
+
+    [[nodiscard]] bool asleep(std::size_t b) const { return sleepers[b].asleep(); }
+
+    // back to being simulated, for when something other than another body has moved it or
+    // changed what it rests on
+    void wake(std::size_t b) { sleepers[b].wake(); }
+
+    // after changing any settings, or the polygons
+    void wakeAll() {
+        for (BasicSleeper<T>& s: sleepers) s.wake();
+    }
+
+    void rebuildPolygons() { grid.rebuild(polys); }
+
+    [[nodiscard]] std::span<const Body>           getBodies() const { return bodies; }
+    [[nodiscard]] const BasicParticles<T>&        getPoints() const { return points; }
+    [[nodiscard]] std::span<const BasicSpring<T>> getSprings() const { return springs; }
+
+    // body b's slice of the shared positions
+    [[nodiscard]] std::span<const Vector2<T>> positions(std::size_t b) const {
+        return std::span(points.pos).subspan(bodies[b].firstPoint, bodies[b].pointCount);
+    }
+
+    void step(ThreadPool* pool = nullptr) {
+        if (grid.polygonCount() != polys.size()) rebuildPolygons();
+        const auto       h = static_cast<T>(dt);
+        const Vector2<T> g(0, static_cast<T>(gravity));
+        auto             forces = [&] {
+            springPhase(pool);
+            contactPhase(pool);
+        };
+        if (!sleeping || integrator != Integrator::symplecticEuler) { // nothing may stay asleep
+            for (BasicSleeper<T>& s: sleepers) {
+                if (s.asleep()) s.wake();
+            }
+        }
+        switch (integrator) {
+        case Integrator::symplecticEuler:
+            if (sleeping) {
+                sleepyStep(h, g, pool);
+                return;
+            }
+            forces();
+            parallelFor(pool, points.size(), [&](std::size_t begin, std::size_t end) {
+                integrate(points, begin, end, h, g, simd);
+            });
+            break;
+        case Integrator::verlet: verletStep(points, h, g, pool, forces); break;
+        case Integrator::rk4: rk4Step(points, h, g, pool, scratch, forces); break;
+        case Integrator::implicitEuler:
+        case Integrator::xpbd:
+            throw std::invalid_argument("World: only the force based integrators are supported");
+        }
+        collidePolygons(points, polys, &grid, pool, nullptr);
+    }
+
+    void run(std::uint64_t n, ThreadPool* pool = nullptr) {
+        for (std::uint64_t i = 0; i < n; i++) step(pool);
+    }
+
+    // the phases of step(), exposed individually for benchmarking
+
+    // every body's springs, each body on one thread. Only those of bodies awake while sleeping
+    void springPhase(ThreadPool* pool = nullptr) {
+        parallelFor(
+            pool, bodies.size(),
+            [&](std::size_t begin, std::size_t end) {
+                for (std::size_t b = begin; b < end; b++) {
+                    if (!sleeping || !sleepers[b].asleep())
+                        springForces(points, springsOf(b), simd);
+                }
+            },
+            1);
+    }
+
+    void contactPhase(ThreadPool* pool = nullptr) {
+        if (!contacts) return;
+        cells.build(points.pos, contactReach());
+        contactForces(points, cells, contactStiffness, contactDamping, pool, reach());
+    }
+
+  private:
+    std::vector<Body>            bodies;
+    std::vector<BasicSleeper<T>> sleepers; // one per body
+    BasicParticles<T>            points;
+    std::vector<std::uint32_t>   owner; // the body of each point
+    std::vector<BasicSpring<T>>  springs; // indices into points, grouped by body
+    std::vector<T>               shells; // per body, the radius of its points to others
+    T                            maxRadius = 0;
+    T                            maxShell  = 0;
+    PolygonGrid                  grid;
+    BasicCellList<T>             cells;
+    BasicIntegratorScratch<T>    scratch;
+
+    [[nodiscard]] std::span<const BasicSpring<T>> springsOf(std::size_t b) const {
+        return std::span(springs).subspan(bodies[b].firstSpring, bodies[b].springCount);
+    }
+
+    // how near points i and j come before they touch, see the top
+    [[nodiscard]] auto reach() const {
+        return [this](std::uint32_t i, std::uint32_t j) {
+            const std::uint32_t a = owner[i];
+            const std::uint32_t b = owner[j];
+            return a == b ? points.radius[i] + points.radius[j] : shells[a] + shells[b];
+        };
+    }
+
+    // the most of that for any pair. With one body only its radii count
+    [[nodiscard]] T contactReach() const {
+        return bodies.size() > 1 ? 2 * std::max(maxRadius, maxShell) : 2 * maxRadius;
+    }
+
+    // A symplectic Euler step of only the bodies which are awake, each body on one thread. The
+    // same sums in the same order as step() for those bodies, so while none sleep it gives the
+    // same result
+    void sleepyStep(T h, const Vector2<T>& g, ThreadPool* pool) {
+        const auto awake = std::ranges::count_if(sleepers, [](auto& s) { return !s.asleep(); });
+        if (awake == 0) return; // all at rest
+        springPhase(pool);
+        if (contacts) {
+            cells.build(points.pos, contactReach());
+            if (static_cast<std::size_t>(awake) < bodies.size()) wakeTouched();
+            contactForces(points, cells, contactStiffness, contactDamping, pool, reach());
+        }
+        parallelFor(
+            pool, bodies.size(),
+            [&](std::size_t begin, std::size_t end) {
+                for (std::size_t b = begin; b < end; b++) {
+                    const std::size_t first = bodies[b].firstPoint;
+                    const std::size_t last  = first + bodies[b].pointCount;
+                    if (sleepers[b].asleep()) { // only contact forces, which it ignores
+                        std::fill(points.f.begin() + static_cast<std::ptrdiff_t>(first),
+                                  points.f.begin() + static_cast<std::ptrdiff_t>(last),
+                                  Vector2<T>());
+                        continue;
+                    }
+                    integrate(points, first, last, h, g, simd);
+                    for (std::size_t i = first; i < last; i++) {
+                        grid.forEachBounding(polys, points.pos[i], [&](const Polygon& poly) {
+                            polyColHandler(points.pos[i], points.vel[i], poly);
+                        });
+                    }
+                    sleepers[b].update(points, first, last);
+                }
+            },
+            1);
+    }
+
+    // Wakes every sleeping body an awake and moving point overlaps, and adds the spring forces
+    // the spring phase skipped. On one thread, as two pairs may wake the same body, but only
+    // while some bodies sleep and others don't
+    void wakeTouched() {
+        cells.forEachPair(nullptr, [&](std::uint32_t i, std::uint32_t j) {
+            const std::uint32_t a = owner[i];
+            const std::uint32_t b = owner[j];
+            if (sleepers[a].asleep() == sleepers[b].asleep()) return;
+            const Vector2<T> d     = points.pos[j] - points.pos[i];
+            const T          touch = reach()(i, j);
+            if (d.dot(d) >= touch * touch) return;
+            const std::uint32_t woken  = sleepers[a].asleep() ? a : b;
+            const std::uint32_t moving = woken == a ? j : i;
+            const Vector2<T>&   v      = points.vel[moving];
+            if (v.dot(v) / (2 * points.invMass[moving]) < sleepers[woken].pointEnergy) return;
+            sleepers[woken].wake();
+            springForces(points, springsOf(woken), simd);
+        });
+    }
+};
+
+using World  = BasicWorld<double>;
+using WorldF = BasicWorld<float>;
@@ -0,0 +1,142 @@
+#pragma once
+
+#include "Broadphase.hpp"
+#include "CellList.hpp"
+#include "Collision.hpp"
+#include "DistanceField.hpp"
+#include "Particles.hpp"
+#include "Polygon.hpp"
+#include "Spring.hpp"
+#include "ThreadPool.hpp"
+#include "Vector2.hpp"
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Extended position based dynamics (Macklin, Mueller & Chentanez 2016). Rather than turning
+// springs into forces it predicts where every particle goes, then moves them back to satisfy
+// each spring as a distance constraint and each polygon as a "stay outside" constraint, and
+// finally derives velocity from how far they actually moved.
+//
+// Each spring's stiffness k becomes a compliance 1 / k (0 would be rigid) scaled by 1/dt^2, so
+// how stretchy a body looks doesn't depend on the timestep, and the cost of a step is a fixed
+// number of iterations however stiff or long it is. The springs are the same as for the force
+// based integrators, so their k and damping mean the same under every integrator. A spring with
+// no stiffness constrains nothing.
+template <typename T>
+class BasicXpbdSolver {
+  public:
+    int iterations = 10;
+
+    // One step of dt. The spring forces in ps.f are not used, only cleared. springs/batchStarts
+    // as from colourSprings(), grid and sdf as in SoftBody::simFrame(). With cells, built over
+    // ps.pos, points which overlap are pushed apart too
+    void step(BasicParticles<T>& ps, std::span<const BasicSpring<T>> springs,
+              std::span<const std::size_t> batchStarts, const std::vector<Polygon>& polys,
+              const PolygonGrid* grid, const DistanceField* sdf, const BasicCellList<T>* cells,
+              T dt, const Vector2<T>& g, ThreadPool* pool) {
+        const std::size_t n = ps.size();
+        prev.assign(ps.pos.begin(), ps.pos.end());
+        lambda.assign(springs.size(), 0);
+        parallelFor(pool, n, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; i++) {
+                ps.vel[i] += g * dt;
+                ps.pos[i] += ps.vel[i] * dt;
+                ps.f[i] = Vector2<T>();
+            }
+        });
+        predicted.assign(ps.pos.begin(), ps.pos.end());
+
+        const T perDt2 = 1 / (dt * dt);
+        for (int it = 0; it < iterations; it++) {
+            // no two springs in a colour batch share a particle, so each batch runs in parallel
+            for (std::size_t c = 0; c + 1 < batchStarts.size(); c++) {
+                const std::size_t first = batchStarts[c];
+                parallelFor(pool, batchStarts[c + 1] - first,
+                            [&](std::size_t begin, std::size_t end) {
+                                for (std::size_t s = first + begin; s < first + end; s++)
+                                    solveSpring(ps, springs[s], lambda[s], perDt2, dt);
+                            });
+            }
+            if (cells != nullptr) solveContacts(ps, *cells, pool);
+            parallelFor(pool, n, [&](std::size_t begin, std::size_t end) {
+                if (sdf != nullptr) {
+                    for (std::size_t i = begin; i < end; i++) {
+                        DistanceField::Sample s   = sdf->sample(Vec2(ps.pos[i]));
+                        double                len = s.grad.mag();
+                        if (s.dist < 0 && len > 1e-10)
+                            ps.pos[i] -= Vector2<T>(s.grad * (s.dist / len));
+                    }
+                    return;
+                }
+                if (grid == nullptr) {
+                    for (const Polygon& poly: polys) {
+                        for (std::size_t i = begin; i < end; i++) {
+                            if (poly.isBounded(Vec2(ps.pos[i]))) polyProject(ps.pos[i], poly);
+                        }
+                    }
+                    return;
+                }
+                for (std::size_t i = begin; i < end; i++) {
+                    grid->forEachBounding(polys, ps.pos[i], [&](const Polygon& poly) {
+                        polyProject(ps.pos[i], poly);
+                    });
+                }
+            });
+        }
+
+        // the predicted velocity plus what the constraints changed, rather than (pos - prev) / dt.
+        // The same, but in float a slow point's move in a step can round away to nothing, and
+        // then it would never pick up speed
+        parallelFor(pool, n, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; i++) ps.vel[i] += (ps.pos[i] - predicted[i]) / dt;
+        });
+    }
+
+  private:
+    std::vector<Vector2<T>> prev;      // positions at the start of the step
+    std::vector<Vector2<T>> predicted; // and where they would go with no constraints
+    std::vector<T>          lambda;    // accumulated multiplier of each spring this step
+    std::vector<Vector2<T>> push;      // contact corrections, gathered before any are applied
+
+    // Rigid, non penetration contacts between points, solved Jacobi style: every point gathers
+    // its share of the correction from each overlap, then they all move at once. The cells were
+    // built at the predicted positions with some slack, as points move a little in between.
+    void solveContacts(BasicParticles<T>& ps, const BasicCellList<T>& cells, ThreadPool* pool) {
+        push.assign(ps.size(), Vector2<T>());
+        cells.forEachPair(pool, [&](std::uint32_t i, std::uint32_t j) {
+            const Vector2<T> d     = ps.pos[j] - ps.pos[i];
+            const T          reach = ps.radius[i] + ps.radius[j];
+            const T          d2    = d.dot(d);
+            if (d2 >= reach * reach || d2 == 0) return;
+            const T          dist = std::sqrt(d2);
+            const Vector2<T> c = d * ((reach - dist) / dist / (ps.invMass[i] + ps.invMass[j]));
+            push[i] -= c * ps.invMass[i];
+            push[j] += c * ps.invMass[j];
+        });
+        parallelFor(pool, ps.size(), [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; i++) ps.pos[i] += push[i];
+        });
+    }
+
+    void solveSpring(BasicParticles<T>& ps, const BasicSpring<T>& s, T& lambda_, T perDt2, T dt) {
+        if (!(s.k > 0)) return;
+        Vector2<T> diff = ps.pos[s.a] - ps.pos[s.b];
+        T          len  = diff.mag();
+        if (len < T(1e-12)) return; // no direction to push in
+        T          alpha = perDt2 / s.k; // the compliance 1 / k, scaled
+        Vector2<T> n     = diff / len;
+        T          c     = len - s.rest;
+        T          w     = ps.invMass[s.a] + ps.invMass[s.b];
+        T          gamma = alpha * s.damp * dt; // alpha~ * beta * dt, see the paper's eq. 26
+        T          dc    = n.dot((ps.pos[s.a] - prev[s.a]) - (ps.pos[s.b] - prev[s.b]));
+        T          dl    = (-c - alpha * lambda_ - gamma * dc) / ((1 + gamma) * w + alpha);
+        lambda_ += dl;
+        ps.pos[s.a] += n * (dl * ps.invMass[s.a]);
+        ps.pos[s.b] -= n * (dl * ps.invMass[s.b]);
+    }
+};
+
+using XpbdSolver = BasicXpbdSolver<double>;
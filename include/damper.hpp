@@ -69,16 +69,11 @@ class damper {
             sum_ -= damped_value_;
         }
 
-        // only use the static_cast when it should be legitimately needed
-        if constexpr (sizeof(Sum) > sizeof(Value)) {
-            // static_cast reduces Sum back to Value if different. "Should fit" after the
-            // division.
-            damped_value_ = static_cast<Value>(sum_ / count_);
-        } else {
-            // this may cause a -Wconversion warning on gcc if -fsanitize=undefined is passed
-            // https://stackoverflow.com/q/71181566/1087626
-            damped_value_ = sum_ / count_;
-        }
+        // static_cast reduces Sum back to Value if different. "Should fit" after the division.
+        // Also needed when they are the same small integer type, because the division promotes
+        // to int, which gcc warns about under -Wconversion with -fsanitize=undefined
+        // https://stackoverflow.com/q/71181566/1087626
+        damped_value_ = static_cast<Value>(sum_ / count_);
         return damped_value_;
     }
 
@@ -91,8 +86,8 @@ class damper {
     }
 
   private:
-    Sum         sum_{};
-    Value       damped_value_{};
-    Count       count_{};
-    const Count time_constant_;
+    Sum   sum_{};
+    Value damped_value_{};
+    Count count_{};
+    Count time_constant_; // not const, so dampers can be members of assignable classes
 };
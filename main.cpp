@@ -1,116 +1,394 @@
+#include <array>
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <future>
 #include <cmath>
 #include <iostream>
-#include <numbers>
+#include <iterator>
+#include <optional>
+#include <span>
 #include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
-#include "Matrix.hpp"
-#include "Point.hpp"
+#include "Checkpoint.hpp"
 #include "Polygon.hpp"
+#include "Profiler.hpp"
+#include "Recording.hpp"
+#include "Render.hpp"
 #include "SFML/Graphics.hpp"
+#include "SimRunner.hpp"
+#include "SoftBody.hpp"
+#include "SpringKernel.hpp"
+#include "StableDt.hpp"
+#include "Trace.hpp"
 #include "Vector2.hpp"
 #include "imgui-SFML.h"
 #include "imgui.h"
 
 float vsScale = 0;
 
-class SoftBody {
-  public:
-    Vec2I size;
-    Vec2  simPos;
-    float springConst = 8000;
-    float dampFact    = 100;
-    float gap;
-
-  private:
-    Matrix<Point>          points;
-    static constexpr float radius = 0.05F;
-
-  public:
-    SoftBody(const Vec2I& size_, float gap_, const Vec2& simPos_, float springConst_,
-             float dampFact_)
-        : size(size_), simPos(simPos_), springConst(springConst_), dampFact(dampFact_), gap(gap_),
-          points(size.x, size.y) {
-        for (int x = 0; x < size.x; x++) {
-            for (int y = 0; y < size.y; y++) {
-                points(x, y) = Point(Vec2(x, y) * gap + simPos, 1.0, radius);
-            }
+void displayFps(double Vfps, double Sfps, sf::RenderWindow& window, const sf::Font& font) {
+    sf::Text text;
+    text.setFont(font); // font is a sf::Font
+    text.setString(std::to_string(static_cast<int>(Vfps)) + " " +
+                   std::to_string(static_cast<int>(Sfps)));
+    text.setCharacterSize(24); // in pixels, not points!
+    text.setFillColor(sf::Color::Red);
+    window.draw(text);
+}
+
+// The render thread's copy of what the ImGui panel edits. The simulation runs on its own thread,
+// so every change is sent over as a command rather than written into the body directly.
+struct Settings {
+    float gravity        = 2.0F;
+    float gap            = 0.2F;
+    float springConst    = 8000;
+    float dampFact       = 100;
+    Vec2I size{25, 25};
+    float dtMs           = 0.1F; // fixed timestep, in ms for the slider
+    bool  adaptive       = true; // or as large as stays stable, see BasicDtController
+    float tolerance      = 0;    // most position error per adaptive step, 0 for none
+    int   maxSubsteps    = 100;
+    bool  paused         = false;
+    int   offlineSteps   = 10'000;
+    int   integrator     = static_cast<int>(Integrator::symplecticEuler);
+    int   xpbdIterations = 10;
+    int   collision      = static_cast<int>(CollisionMode::exact);
+    float sdfResolution  = 16; // cells per unit
+    bool  selfCollision  = false; // costs about half as much again as the rest of a step
+    bool  sleeping       = true; // stop simulating the body once it comes to rest
+    int   recordStride   = 1;
+    bool  compress       = false; // 4-5x smaller files, but ~16% slower steps on one core
+    float quantum        = 1e-4F; // of compressed recordings, in simulation units
+};
+
+SimBody defaultBody(const Settings& s = {}) {
+    SimBody sb(s.size, s.gap, Vector2<SimScalar>(3, 0), s.springConst, s.dampFact);
+    sb.integrator      = static_cast<Integrator>(s.integrator);
+    sb.xpbd.iterations = s.xpbdIterations;
+    sb.selfCollision   = s.selfCollision;
+    sb.sleeper.enabled = s.sleeping;
+    return sb;
+}
+
+std::vector<Polygon> defaultPolygons() {
+    return {Polygon::Square(Vec2(6, 10), -0.75), Polygon::Square(Vec2(14, 10), 0.75),
+            Polygon::Triangle(Vec2(100, 100))};
+}
+
+// largestStableDt() takes seconds, so it runs in the background on a copy of the default scene
+// with the current settings
+struct StableDtSearch {
+    std::future<double> result;
+    double              dt         = 0;
+    int                 integrator = -1; // which integrator dt is for
+};
+
+// where the record button writes and the replay button reads
+const std::string recordingPath = "softbody.rec";
+
+// where traces are saved, on the button or on exit while tracing
+const std::string tracePath = "softbody.trace.json";
+
+// A recording being played back in place of the simulation, which is paused meanwhile
+struct ReplayView {
+    std::optional<Replay> replay;
+    std::vector<Vec2>     pos;
+    double                frame   = 0; // fractional, so slow playback still moves
+    float                 speed   = 1; // times real time
+    bool                  playing = true;
+    std::string           error;
+};
+
+void displayRecording(Settings& ui, SimRunner& sim, const BodySnapshot& snap, ReplayView& view) {
+    bool recording = snap.recording;
+    if (ImGui::Checkbox("Record", &recording)) {
+        if (recording) {
+            RecordOptions options;
+            options.stride  = ui.recordStride;
+            options.quantum = ui.compress ? ui.quantum : 0;
+            sim.record(recordingPath, options);
+        } else {
+            sim.stopRecording();
         }
     }
-
-    void reset() { // evil function
-        *this = SoftBody(size, gap, simPos, springConst, dampFact);
-    }
-
-    void draw(sf::RenderWindow& window) {
-        for (Point& point: points.v) point.draw(window);
-    }
-
-    void simFrame(double deltaTime, double gravity, const std::vector<Polygon>& polys) {
-        for (int x = 0; x < points.sizeX; x++) {
-            for (int y = 0; y < points.sizeY; y++) {
-                Point& p = points(x, y);
-                if (x < points.sizeX - 1) {
-                    if (y < points.sizeY - 1) {
-                        Point::springHandler(p, points(x + 1, y + 1), std::numbers::sqrt2 * gap,
-                                             springConst, dampFact); // down right
-                    }
-                    Point::springHandler(p, points(x + 1, y), gap, springConst, dampFact); // right
-                }
-                if (y < points.sizeY - 1) {
-                    if (x > 0) {
-                        Point::springHandler(p, points(x - 1, y + 1), std::numbers::sqrt2 * gap,
-                                             springConst, dampFact); // down left
-                    }
-                    Point::springHandler(p, points(x, y + 1), gap, springConst, dampFact); // down
-                }
+    ImGui::SameLine();
+    ImGui::Text("%llu frames, %.1f MiB", static_cast<unsigned long long>(snap.recordedFrames),
+                static_cast<double>(snap.recordedBytes) / (1024 * 1024));
+    ImGui::DragInt("Record every", &ui.recordStride, 1, 1, 1000, "%d steps");
+    ImGui::Checkbox("Compress", &ui.compress);
+
+    if (!view.replay) {
+        if (ImGui::Button("Replay")) {
+            try {
+                view.replay.emplace(recordingPath);
+                if (view.replay->frames() == 0) throw std::runtime_error("replay: no frames yet");
+                view.frame   = 0;
+                view.playing = true;
+                view.error.clear();
+                ui.paused = true;
+                sim.post([](SimState& s) { s.paused = true; });
+            } catch (const std::exception& e) {
+                view.replay.reset();
+                view.error = e.what();
             }
         }
-        for (Point& point: points.v) {
-            point.update(deltaTime, gravity);
-        }
+        if (!view.error.empty()) ImGui::Text("%s", view.error.c_str());
+        return;
+    }
+    const Replay& replay = *view.replay;
+    ImGui::Checkbox("Play", &view.playing);
+    ImGui::SameLine();
+    ImGui::DragFloat("Speed", &view.speed, 0.05F, 0.01F, 1000);
+    int frame = static_cast<int>(view.frame);
+    if (ImGui::SliderInt("Frame", &frame, 0, static_cast<int>(replay.frames()) - 1))
+        view.frame = frame;
+    ImGui::Text("step %llu, %zu frames, %.1f MiB",
+                static_cast<unsigned long long>(replay.step(static_cast<std::size_t>(frame))),
+                replay.frames(), static_cast<double>(replay.bytes()) / (1024 * 1024));
+    if (ImGui::Button("Close replay")) view.replay.reset();
+}
+
+// moves playback on by `seconds` of real time, and stops at the end
+void advance(ReplayView& view, double seconds) {
+    if (!view.replay || !view.playing) return;
+    const double last = static_cast<double>(view.replay->frames() - 1);
+    view.frame += seconds * view.speed / (view.replay->dt() * view.replay->stride());
+    if (view.frame >= last) {
+        view.frame   = last;
+        view.playing = false;
+    }
+}
+
+void drawReplay(sf::RenderWindow& window, BodyRenderer& renderer, ReplayView& view) {
+    try {
+        view.replay->frame(static_cast<std::size_t>(view.frame), view.pos);
+    } catch (const std::exception& e) {
+        view.replay.reset();
+        view.error = e.what();
+        return;
+    }
+    renderer.draw(window, view.pos, view.replay->radius(), view.replay->springs());
+    for (const Polygon& poly: view.replay->polygons()) draw(window, poly);
+}
 
-        for (const Polygon& poly: polys) {
-            for (Point& point: points.v) {
-                if (poly.isBounded(point.pos)) point.polyColHandler(poly);
+// The checkpoint buttons share one buffer, owned by main and only touched by commands, so only
+// ever by the simulation thread
+void displayCheckpoints(SimRunner& sim, std::vector<std::byte>& checkpoint) {
+    if (ImGui::Button("Checkpoint"))
+        sim.post([&checkpoint](SimState& s) { s.save(checkpoint); });
+    ImGui::SameLine();
+    if (ImGui::Button("Rewind")) {
+        sim.post([&checkpoint](SimState& s) {
+            try {
+                if (!checkpoint.empty()) s.restore(checkpoint);
+            } catch (const std::exception& e) {
+                std::cerr << e.what() << '\n';
+                checkpoint.clear();
             }
-        }
+        });
     }
-};
+    ImGui::SameLine();
+    if (ImGui::Button("Save file")) {
+        sim.post([&checkpoint](SimState& s) {
+            s.save(checkpoint);
+            try {
+                saveCheckpointFile("softbody.ckpt", checkpoint);
+            } catch (const std::exception& e) {
+                std::cerr << e.what() << '\n';
+            }
+        });
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Load file")) {
+        sim.post([&checkpoint](SimState& s) {
+            try {
+                loadCheckpointFile("softbody.ckpt", checkpoint);
+                s.restore(checkpoint);
+            } catch (const std::exception& e) {
+                std::cerr << e.what() << '\n';
+                checkpoint.clear();
+            }
+        });
+    }
+}
 
-sf::Vector2f visualize(const Vec2& v) {
-    return sf::Vector2f(static_cast<float>(v.x), static_cast<float>(v.y)) * vsScale;
+void displayPhases(const char* table, std::span<const PhaseStats> stats, Phase first) {
+    if (!ImGui::BeginTable(table, 6, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) return;
+    for (const char* heading: {"", "min", "avg", "max", "p50", "p99"})
+        ImGui::TableSetupColumn(heading);
+    ImGui::TableHeadersRow();
+    for (std::size_t p = 0; p < stats.size(); p++) {
+        const PhaseStats& s = stats[p];
+        if (s.samples == 0) continue; // not run in this configuration
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
+        ImGui::Text("%s", phaseNames[static_cast<std::size_t>(first) + p]);
+        for (double us: {s.min, s.avg, s.max, s.p50, s.p99}) {
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f", us);
+        }
+    }
+    ImGui::EndTable();
 }
 
-void displayFps(double Vfps, double Sfps, sf::RenderWindow& window, const sf::Font& font) {
-    sf::Text text;
-    text.setFont(font); // font is a sf::Font
-    text.setString(std::to_string(static_cast<int>(Vfps)) + " " +
-                   std::to_string(static_cast<int>(Sfps)));
-    text.setCharacterSize(24); // in pixels, not points!
-    text.setFillColor(sf::Color::Red);
-    window.draw(text);
+// Where the time goes, in microseconds per call over the last Profiler::window calls: each phase
+// of a simulation step, and of a frame on this thread
+void displayProfiler(const BodySnapshot& snap, Profiler& profiler,
+                     std::array<PhaseStats, phaseCount>& frame, Tracer& tracer,
+                     std::string& traceStatus) {
+    ImGui::Begin("Profiler");
+#ifndef SOFTBODY_PROFILE
+    ImGui::Text("Built without SOFTBODY_PROFILE, so nothing is timed or traced");
+#endif
+    // every thread's timeline, to open in chrome://tracing or ui.perfetto.dev
+    bool tracing = tracer.active();
+    if (ImGui::Checkbox("Trace", &tracing)) {
+        if (tracing)
+            tracer.start();
+        else
+            tracer.stop();
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Save trace")) {
+        try {
+            tracer.save(tracePath);
+            traceStatus = "saved " + tracePath;
+        } catch (const std::exception& e) {
+            traceStatus = e.what();
+        }
+    }
+    if (!traceStatus.empty()) {
+        ImGui::SameLine();
+        ImGui::Text("%s", traceStatus.c_str());
+    }
+    const auto split = static_cast<std::size_t>(Phase::frame);
+    for (std::size_t p = split; p < phaseCount; p++)
+        frame[p] = profiler.stats(static_cast<Phase>(p));
+    ImGui::Text("Simulation, per step");
+    displayPhases("simulation", std::span(snap.profile).first(split), Phase::step);
+    ImGui::Text("Render, per frame");
+    displayPhases("render", std::span(frame).subspan(split), Phase::frame);
+    ImGui::End();
 }
 
-void displayImGui(SoftBody& sb, float& gravity) {
+void displayImGui(Settings& ui, SimRunner& sim, BodyRenderer& renderer, StableDtSearch& search) {
     ImGui::Begin("Settings");
-    ImGui::DragFloat("Gravity", &gravity, 0.01F);
-    ImGui::DragFloat("Gap", &sb.gap, 0.005F);
-    ImGui::DragFloat("Spring Constant", &sb.springConst, 10.0F, 0.0F, 20000.0F);
-    ImGui::DragFloat("Damping Factor", &sb.dampFact, 1.0F, 0.0F, 300.0F);
-    ImGui::DragInt("Size X", &sb.size.x, 1, 2, 50);
-    ImGui::DragInt("Size Y", &sb.size.y, 1, 2, 50);
+    if (ImGui::DragFloat("Gravity", &ui.gravity, 0.01F))
+        sim.post([g = ui.gravity](SimState& s) { s.gravity = g; });
+    bool springsChanged = ImGui::DragFloat("Gap", &ui.gap, 0.005F);
+    springsChanged |= ImGui::DragFloat("Spring Constant", &ui.springConst, 10.0F, 0.0F, 20000.0F);
+    springsChanged |= ImGui::DragFloat("Damping Factor", &ui.dampFact, 1.0F, 0.0F, 300.0F);
+    if (springsChanged) {
+        sim.post([ui](SimState& s) {
+            s.body.gap         = ui.gap;
+            s.body.springConst = ui.springConst;
+            s.body.dampFact    = ui.dampFact;
+            s.body.updateSprings();
+        });
+    }
+    bool steppingChanged = ImGui::DragFloat("Time step (ms)", &ui.dtMs, 0.001F, 0.001F, 20.0F);
+    steppingChanged |= ImGui::DragInt("Max substeps", &ui.maxSubsteps, 1, 1, 10'000);
+    steppingChanged |= ImGui::Checkbox("Pause", &ui.paused);
+    steppingChanged |= ImGui::Checkbox("Adaptive dt", &ui.adaptive);
+    if (ui.adaptive) {
+        steppingChanged |=
+            ImGui::DragFloat("Error tolerance", &ui.tolerance, 1e-6F, 0.0F, 1e-2F, "%.2e");
+    }
+    if (steppingChanged) {
+        sim.post([ui](SimState& s) {
+            s.dt                 = ui.dtMs / 1000.0; // until the runner's next tick, if adaptive
+            s.maxSubsteps        = ui.maxSubsteps;
+            s.paused             = ui.paused;
+            s.adaptive.enabled   = ui.adaptive;
+            s.adaptive.tolerance = ui.tolerance;
+        });
+    }
+    if (ImGui::Combo("Integrator", &ui.integrator, integratorNames,
+                     static_cast<int>(std::size(integratorNames)))) {
+        sim.post([i = static_cast<Integrator>(ui.integrator)](SimState& s) {
+            s.body.integrator = i;
+        });
+    }
+    if (ui.integrator == static_cast<int>(Integrator::xpbd)) {
+        if (ImGui::DragInt("Iterations", &ui.xpbdIterations, 1, 1, 200)) {
+            sim.post([n = ui.xpbdIterations](SimState& s) { s.body.xpbd.iterations = n; });
+        }
+    }
+    if (search.result.valid()) {
+        if (search.result.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+            search.dt = search.result.get();
+        else
+            ImGui::Text("Searching for the largest stable dt...");
+    } else if (ImGui::Button("Find stable dt")) {
+        search.integrator = ui.integrator;
+        search.result     = std::async(std::launch::async, [ui] {
+            return largestStableDt(defaultBody(ui), defaultPolygons(), ui.gravity);
+        });
+    }
+    if (search.integrator >= 0 && !search.result.valid()) {
+        ImGui::SameLine();
+        ImGui::Text("%s: %.3f ms", integratorNames[search.integrator], search.dt * 1000);
+    }
+    bool collisionChanged = ImGui::Combo("Collision", &ui.collision, collisionModeNames,
+                                         static_cast<int>(std::size(collisionModeNames)));
+    if (ui.collision != static_cast<int>(CollisionMode::exact)) {
+        // memory goes up with the square of this, the error down roughly linearly
+        collisionChanged |=
+            ImGui::DragFloat("SDF resolution", &ui.sdfResolution, 0.25F, 1.0F, 128.0F, "%.0f");
+    }
+    if (collisionChanged) {
+        sim.post([ui](SimState& s) {
+            s.collision     = static_cast<CollisionMode>(ui.collision);
+            s.sdfResolution = ui.sdfResolution;
+        }); // the runner rebuilds the field after every command
+    }
+    if (ImGui::Checkbox("Self collision", &ui.selfCollision))
+        sim.post([on = ui.selfCollision](SimState& s) { s.body.selfCollision = on; });
+    if (ImGui::Checkbox("Sleep at rest", &ui.sleeping))
+        sim.post([on = ui.sleeping](SimState& s) { s.body.sleeper.enabled = on; });
+    // deterministic: exactly this many steps of dt, as fast as possible, then back to real time
+    ImGui::InputInt("##offline", &ui.offlineSteps);
+    ImGui::SameLine();
+    if (ImGui::Button("Run steps") && ui.offlineSteps > 0)
+        sim.post([n = ui.offlineSteps](SimState& s) { s.run(static_cast<std::uint64_t>(n)); });
+    // live: the body grows or shrinks in place as either is dragged
+    bool sizeChanged = ImGui::DragInt("Size X", &ui.size.x, 1, 2, 200);
+    sizeChanged |= ImGui::DragInt("Size Y", &ui.size.y, 1, 2, 200);
+    if (sizeChanged) sim.post([size = ui.size](SimState& s) { s.body.resize(size); });
     ImGui::DragFloat("Zoom", &vsScale, 1, 0, 250);
-    if (ImGui::Button("Reset sim")) sb.reset();
+    ImGui::Checkbox("Draw springs", &renderer.drawSprings);
+    ImGui::Text("SIMD: %s, %s precision", simdName(detectSimd()),
+                std::is_same_v<SimScalar, float> ? "single" : "double");
+    if (ImGui::Button("Reset sim")) {
+        sim.post([ui](SimState& s) {
+            s.body.size = ui.size;
+            s.body.reset();
+        });
+    }
     ImGui::SameLine();
     if (ImGui::Button("Default sim")) {
-        sb      = SoftBody(Vec2I(25, 25), 0.2F, Vec2(3, 0), 8000, 100);      
-        gravity = 2.0F;
+        ui = Settings{};
+        sim.post([ui](SimState& s) {
+            s.body               = defaultBody(ui);
+            s.collision          = static_cast<CollisionMode>(ui.collision);
+            s.sdfResolution      = ui.sdfResolution;
+            s.gravity            = ui.gravity;
+            s.dt                 = ui.dtMs / 1000.0;
+            s.maxSubsteps        = ui.maxSubsteps;
+            s.paused             = ui.paused;
+            s.adaptive.enabled   = ui.adaptive;
+            s.adaptive.tolerance = ui.tolerance;
+        });
     }
 }
 
 int main() {
-    float gravity = 2;
+    Settings ui;
 
     const Vec2I screen(sf::VideoMode::getDesktopMode().width,
                        sf::VideoMode::getDesktopMode().height);
@@ -128,67 +406,105 @@ int main() {
     sf::RenderWindow window(sf::VideoMode::getDesktopMode(), "Soft Body Simulation",
                             sf::Style::Fullscreen, settings); //, sf::Style::Default);
     ImGui::SFML::Init(window);
+    BodyRenderer renderer;
 
-    SoftBody sb(Vec2I(25, 25), 0.2F, Vec2(3, 0), 8000, 100);
+    nameTraceThread("Render");
+    Tracer      tracer; // outlives every thread below, which may record into it
+    std::string traceStatus;
 
-    std::vector<Polygon> polys;
-    polys.push_back(Polygon::Square(Vec2(6, 10), -0.75));
-    polys.push_back(Polygon::Square(Vec2(14, 10), 0.75));
-    polys.push_back(Polygon::Triangle(Vec2(100, 100)));
+    StableDtSearch         search;
+    std::vector<std::byte> checkpoint; // outlives sim, whose commands use it
+    ReplayView             view;
 
-    std::chrono::_V2::system_clock::time_point last = std::chrono::high_resolution_clock::now();
-    double                                     Vfps = 0;
+    // the simulation runs on its own thread from here on
+    SimState initial{defaultBody(ui), defaultPolygons(), ui.gravity};
+    initial.dt                 = ui.dtMs / 1000.0;
+    initial.maxSubsteps        = ui.maxSubsteps;
+    initial.adaptive.enabled   = ui.adaptive;
+    initial.adaptive.tolerance = ui.tolerance;
+    SimRunner sim(std::move(initial));
+
+    double Vfps = 0;
 
     sf::Clock
         deltaClock; // for imgui - read https://eliasdaler.github.io/using-imgui-with-sfml-pt1/
+    Profiler                           profiler; // of this thread's frames
+    const InstallProfiler              profiling(profiler);
+    std::array<PhaseStats, phaseCount> frameProfile;
     while (window.isOpen()) {
-        std::chrono::_V2::system_clock::time_point start =
-            std::chrono::high_resolution_clock::now();
+        SOFTBODY_TIME(Phase::frame);
+        auto start = std::chrono::steady_clock::now();
 
         // clear poll events for sfml and imgui
         sf::Event event; //NOLINT
-        while (window.pollEvent(event)) {
-            ImGui::SFML::ProcessEvent(event);
-            if (event.type == sf::Event::Closed) window.close();
+        {
+            SOFTBODY_TRACE("Events");
+            while (window.pollEvent(event)) {
+                ImGui::SFML::ProcessEvent(event);
+                if (event.type == sf::Event::Closed) window.close();
+            }
         }
 
-        ImGui::SFML::Update(window, deltaClock.restart());
-        displayImGui(sb, gravity);
-
-        int simFrames = 0;
-
-        std::chrono::nanoseconds sinceVFrame = std::chrono::high_resolution_clock::now() - start;
-        while ((sinceVFrame.count() < 10'000'000)) { // TODO: min max avg frames test
-            ++simFrames;
-            std::chrono::_V2::system_clock::time_point newLast =
-                std::chrono::high_resolution_clock::now();
-            constexpr std::chrono::nanoseconds maxFrame{1'000'000};
-            std::chrono::nanoseconds           deltaTime = std::min(newLast - last, maxFrame);
-            last                                         = newLast;
-
-            sb.simFrame(static_cast<double>(deltaTime.count()) / 1e9, gravity, polys);
-            sinceVFrame = std::chrono::high_resolution_clock::now() - start;
+        // draw the latest state the simulation has published, never waiting for it
+        const BodySnapshot& snap  = sim.latest();
+        const sf::Time      delta = deltaClock.restart();
+        {
+            SOFTBODY_TIME(Phase::imgui);
+            ImGui::SFML::Update(window, delta);
+            displayImGui(ui, sim, renderer, search);
+            displayCheckpoints(sim, checkpoint);
+            displayRecording(ui, sim, snap, view);
+            if (snap.asleep)
+                ImGui::Text("Asleep");
+            else if (snap.restingRegions > 0)
+                ImGui::Text("At rest: %zu of %zu regions", snap.restingRegions, snap.regionCount);
+            if (std::isfinite(snap.dtBound))
+                ImGui::Text("dt: %.3f ms, stable below %.3f ms", snap.dt * 1000,
+                            snap.dtBound * 1000);
+            else
+                ImGui::Text("dt: %.3f ms, unconditionally stable", snap.dt * 1000);
+            if (snap.cgIterations > 0) ImGui::Text("CG iterations: %d", snap.cgIterations);
+            if (snap.sdfBytes > 0)
+                ImGui::Text("SDF: %.1f KiB", static_cast<double>(snap.sdfBytes) / 1024);
+            if (ui.collision == static_cast<int>(CollisionMode::compare)) {
+                ImGui::Text(
+                    "SDF error: mean %.4f, max %.4f over %zu points, %zu on the wrong side",
+                    snap.sdfError.meanError, snap.sdfError.maxError, snap.sdfError.samples,
+                    snap.sdfError.wrongSide);
+            }
+            ImGui::End();
+            displayProfiler(snap, profiler, frameProfile, tracer, traceStatus);
+        }
+        advance(view, static_cast<double>(delta.asSeconds()));
+
+        {
+            SOFTBODY_TIME(Phase::render);
+            window.clear();
+            displayFps(Vfps, snap.simFps, window, font);
+            if (view.replay) {
+                drawReplay(window, renderer, view);
+            } else {
+                renderer.draw(window, snap);
+                for (const Polygon& poly: snap.polys) draw(window, poly);
+            }
+            ImGui::SFML::Render(window); // end and draw
+        }
+        {
+            SOFTBODY_TIME(Phase::display);
+            window.display();
         }
 
-        // draw
-        double Sfps = 1e9 * simFrames / static_cast<double>(sinceVFrame.count());
-        // double Sfps = simFrames;
-
-        window.clear();
-        displayFps(Vfps, Sfps, window, font);
-
-        sb.draw(window);
-        for (Polygon& poly: polys) poly.draw(window);
-
-        ImGui::End();
-        ImGui::SFML::Render(window); // end and draw
-        window.display();
-
-        sinceVFrame = std::chrono::high_resolution_clock::now() - start;
-        // std::cout << sinceVFrame.count() << "ns\n";
+        std::chrono::nanoseconds sinceVFrame = std::chrono::steady_clock::now() - start;
         Vfps = 1e9 / static_cast<double>(sinceVFrame.count());
     }
+    if (tracer.active()) {
+        try {
+            tracer.save(tracePath);
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << '\n';
+        }
+    }
     ImGui::SFML::Shutdown();
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,156 @@
+#include "Integrator.hpp"
+#include "Particles.hpp"
+#include "SimRunner.hpp"
+#include "SoftBody.hpp"
+#include "Spring.hpp"
+#include "StableDt.hpp"
+#include "gtest/gtest.h"
+#include "scenes.hpp"
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace {
+
+// the bound for two points of mass m on a spring of stiffness k and no damping
+double pairBound(double m, double k) {
+    Particles ps;
+    ps.add(Vec2(0, 0), m, 0.1);
+    ps.add(Vec2(1, 0), m, 0.1);
+    const std::vector<Spring> springs{{0, 1, 1, k, 0}};
+    DtController              adaptive;
+    return adaptive.stabilityBound(ps, springs, Integrator::symplecticEuler);
+}
+
+} // namespace
+
+// for a lone pair the discs are exact: it oscillates at sqrt(2 k / m), stable below 2 over that
+TEST(adaptive_dt, pairBoundIsExact) { // NOLINT
+    EXPECT_NEAR(pairBound(1, 8000), std::sqrt(2.0 / 8000), 1e-12);
+    EXPECT_NEAR(pairBound(0.25, 8000), pairBound(1, 8000) / 2, 1e-12); // lighter is faster
+    EXPECT_NEAR(pairBound(1, 32000), pairBound(1, 8000) / 2, 1e-12);   // as is stiffer
+}
+
+// below the largest stable dt found by simulating, but not so far below it to waste steps.
+// rk4 damps the fastest modes of a stiff body far better than its bound assumes, so is only safe
+TEST(adaptive_dt, boundIsSafeButNotTooCautious) { // NOLINT
+    for (Integrator integrator:
+         {Integrator::symplecticEuler, Integrator::verlet, Integrator::rk4}) {
+        SCOPED_TRACE(integratorNames[static_cast<int>(integrator)]);
+        for (float k: {500.0F, 8000.0F, 20000.0F}) {
+            SCOPED_TRACE(k);
+            SimState s        = testScene(Vec2I(10, 10), k, 100);
+            s.body.integrator = integrator;
+            s.adaptive.update(s.body);
+            const double measured = largestStableDt(s.body, s.polys, s.gravity);
+            EXPECT_LE(s.adaptive.bound(), measured);
+            if (integrator != Integrator::rk4) {
+                EXPECT_GE(s.adaptive.bound(), 0.3 * measured);
+            }
+        }
+    }
+}
+
+TEST(adaptive_dt, dampingShrinksTheBound) { // NOLINT
+    double previous = std::numeric_limits<double>::infinity();
+    for (float damp: {0.0F, 100.0F, 300.0F}) {
+        SimState s = testScene(Vec2I(10, 10), 8000, damp);
+        s.adaptive.update(s.body);
+        EXPECT_LT(s.adaptive.bound(), previous) << damp;
+        previous = s.adaptive.bound();
+    }
+}
+
+// contacts between points are stiff springs too, and the body still holds together at the bound
+TEST(adaptive_dt, selfCollisionShrinksTheBound) { // NOLINT
+    SimState s = testScene(Vec2I(10, 10), 8000, 100);
+    s.adaptive.update(s.body);
+    const double apart   = s.adaptive.bound();
+    s.body.selfCollision = true;
+    s.adaptive.update(s.body);
+    EXPECT_LT(s.adaptive.bound(), apart);
+    EXPECT_TRUE(stableAt(s.body, s.polys, s.gravity, s.adaptive.bound(), 1.0, nullptr));
+
+    // alone, a point's contacts set the bound the way springs would
+    Particles ps;
+    ps.add(Vec2(0, 0), 1, 0.1);
+    DtController adaptive;
+    EXPECT_NEAR(adaptive.stabilityBound(ps, {}, Integrator::symplecticEuler, 8000),
+                std::sqrt(1.0 / (6 * 8000 * 2)) * 2, 1e-12);
+}
+
+TEST(adaptive_dt, unconditionallyStableTakeMaxDt) { // NOLINT
+    for (Integrator integrator: {Integrator::implicitEuler, Integrator::xpbd}) {
+        SimState s        = testScene(Vec2I(10, 10), 20000, 300);
+        s.body.integrator = integrator;
+        s.adaptive.update(s.body);
+        EXPECT_TRUE(std::isinf(s.adaptive.bound()));
+        EXPECT_EQ(s.adaptive.dt(), s.adaptive.maxDt);
+    }
+}
+
+// the stiffest body the ui allows, which blows up at the fixed dt the soft one is happy with
+TEST(adaptive_dt, stiffBodyStaysStable) { // NOLINT
+    SimState s = testScene(Vec2I(10, 10), 20000, 300);
+    EXPECT_FALSE(stableAt(s.body, s.polys, s.gravity, 2e-3, 2.0, nullptr));
+
+    s.dt               = 2e-3;
+    s.adaptive.enabled = true;
+    s.adaptive.update(s.body);
+    double simTime = 0;
+    while (simTime < 2.0) {
+        s.run(1);
+        simTime += s.dt;
+    }
+    EXPECT_TRUE(isStable(s.body.getPoints()));
+    EXPECT_LT(s.dt, 2e-3);
+    EXPECT_EQ(s.dt, s.adaptive.bound()); // and took the largest step it could
+}
+
+// a tolerance takes smaller steps than stability alone, and keeps each step's error near it
+TEST(adaptive_dt, toleranceBoundsTheError) { // NOLINT
+    // soft, so the bound is large, and squeezed so it rings. Nothing to hit, as a collision's
+    // change of velocity isn't integration error but would still count as it
+    SimState s = testScene(Vec2I(10, 10), 500, 10);
+    s.polys.clear();
+    s.gravity = 0;
+    for (BasicSpring<SimScalar>& spring: s.body.getSprings()) spring.rest *= 0.8F;
+    s.adaptive.enabled   = true;
+    s.adaptive.tolerance = 1e-5;
+    s.adaptive.update(s.body);
+    for (int i = 0; i < 2000; i++) {
+        s.run(1);
+        if (i >= 10) {
+            EXPECT_LE(s.adaptive.error(), 2 * s.adaptive.tolerance) << i;
+        }
+    }
+    EXPECT_TRUE(isStable(s.body.getPoints()));
+    EXPECT_LT(s.adaptive.dt(), s.adaptive.bound());
+    EXPECT_GT(s.adaptive.error(), 0);
+}
+
+TEST(adaptive_dt, checkpointCarriesOn) { // NOLINT
+    SimState s = testScene(Vec2I(10, 10), 8000, 100);
+    s.adaptive.enabled   = true;
+    s.adaptive.tolerance = 1e-5;
+    s.adaptive.safety    = 0.8;
+    s.adaptive.update(s.body);
+    s.run(100);
+    std::vector<std::byte> checkpoint;
+    s.save(checkpoint);
+    s.run(100);
+    const auto   pos = s.body.getPoints().pos;
+    const double dt  = s.dt;
+
+    // different springs, so a different bound until restored
+    SimState b = testScene(Vec2I(10, 10), 100, 1);
+    b.restore(checkpoint);
+    EXPECT_TRUE(b.adaptive.enabled);
+    EXPECT_EQ(b.adaptive.tolerance, s.adaptive.tolerance);
+    EXPECT_EQ(b.adaptive.safety, 0.8);
+    EXPECT_EQ(b.adaptive.bound(), s.adaptive.bound());
+    b.run(100);
+    EXPECT_EQ(b.body.getPoints().pos, pos);
+    EXPECT_EQ(b.dt, dt);
+}
@@ -0,0 +1,70 @@
+#include "Broadphase.hpp"
+#include "Polygon.hpp"
+#include "SoftBody.hpp"
+#include "StableDt.hpp"
+#include "ThreadPool.hpp"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+
+// a scattered field of triangles below the test body, many overlapping, plus one big far away
+// square
+std::vector<Polygon> field() {
+    std::vector<Polygon> polys;
+    std::mt19937         rng(7); // NOLINT
+    std::uniform_real_distribution<double> at(0, 12);
+    for (int i = 0; i < 200; i++) polys.push_back(Polygon::Triangle(Vec2(at(rng), 3 + at(rng))));
+    polys.push_back(Polygon::Square(Vec2(60, 40), 0.3));
+    return polys;
+}
+
+} // namespace
+
+TEST(broadphase, nearFindsEveryBoundingPolygon) { // NOLINT
+    std::vector<Polygon> polys = field();
+    PolygonGrid          grid(polys);
+    std::mt19937         rng(11); // NOLINT
+    std::uniform_real_distribution<double> at(-2, 70);
+    for (int i = 0; i < 10'000; i++) {
+        Vec2                           pos(at(rng), at(rng));
+        std::span<const std::uint32_t> near = grid.near(pos);
+        EXPECT_TRUE(std::is_sorted(near.begin(), near.end()));
+        for (std::uint32_t p = 0; p < polys.size(); p++) {
+            if (polys[p].isBounded(pos)) {
+                EXPECT_TRUE(std::binary_search(near.begin(), near.end(), p)) << pos;
+            }
+        }
+    }
+}
+
+TEST(broadphase, matchesBruteForceExactly) { // NOLINT
+    std::vector<Polygon> polys = field();
+    PolygonGrid          grid(polys);
+    SoftBody             brute(Vec2I(40, 30), 0.2F, Vec2(2, -4.5), 8000, 100);
+    SoftBody             gridded = brute;
+    ThreadPool           pool(3);
+    for (int i = 0; i < 3000; i++) {
+        brute.simFrame(1e-4, 60.0, polys);
+        gridded.simFrame(1e-4, 60.0, polys, &pool, &grid);
+    }
+    ASSERT_TRUE(isStable(brute.getPoints()));
+    EXPECT_EQ(brute.getPoints().pos, gridded.getPoints().pos);
+    EXPECT_EQ(brute.getPoints().vel, gridded.getPoints().vel);
+}
+
+TEST(broadphase, rebuildFollowsMovedPolygons) { // NOLINT
+    std::vector<Polygon> polys{Polygon::Triangle(Vec2(0, 0)), Polygon::Triangle(Vec2(5, 5))};
+    PolygonGrid          grid(polys);
+    EXPECT_TRUE(grid.near(Vec2(30, 30)).empty());
+
+    polys[1] = Polygon::Triangle(Vec2(30, 30));
+    grid.rebuild(polys);
+    std::span<const std::uint32_t> near = grid.near(Vec2(30, 30));
+    ASSERT_EQ(near.size(), 1U);
+    EXPECT_EQ(near[0], 1U);
+    EXPECT_TRUE(grid.near(Vec2(5, 5)).empty());
+}
@@ -0,0 +1,203 @@
+#include "Checkpoint.hpp"
+#include "Integrator.hpp"
+#include "Polygon.hpp"
+#include "SimRunner.hpp"
+#include "SoftBody.hpp"
+#include "StableDt.hpp"
+#include "gtest/gtest.h"
+#include "scenes.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+TEST(checkpoint, rewindRepeatsTheSameSteps) { // NOLINT
+    for (Integrator integrator: {Integrator::symplecticEuler, Integrator::implicitEuler,
+                                 Integrator::xpbd}) {
+        SCOPED_TRACE(integratorNames[static_cast<int>(integrator)]);
+        SimState s        = testScene();
+        s.body.integrator = integrator;
+        s.run(300);
+        std::vector<std::byte> checkpoint;
+        s.save(checkpoint);
+        s.run(300);
+        const auto pos = s.body.getPoints().pos;
+        const auto vel = s.body.getPoints().vel;
+
+        s.restore(checkpoint);
+        EXPECT_EQ(s.steps, 300U);
+        s.run(300);
+        EXPECT_EQ(s.body.getPoints().pos, pos);
+        EXPECT_EQ(s.body.getPoints().vel, vel);
+    }
+}
+
+TEST(checkpoint, restoresSettingsAndPolygons) { // NOLINT
+    SimState a           = testScene();
+    a.body.selfCollision = true;
+    std::vector<std::byte> checkpoint;
+    a.save(checkpoint);
+
+    SimState b = SimState{SimBody(Vec2I(4, 4), 0.3F, {0, 0}, 100, 1), {}, 9.0};
+    b.collision          = CollisionMode::sdf;
+    b.body.integrator    = Integrator::rk4;
+    b.body.selfCollision = false;
+    b.restore(checkpoint);
+    EXPECT_EQ(b.gravity, a.gravity);
+    EXPECT_EQ(b.collision, CollisionMode::exact);
+    EXPECT_EQ(b.body.integrator, Integrator::symplecticEuler);
+    EXPECT_TRUE(b.body.selfCollision);
+    EXPECT_EQ(b.body.size, a.body.size);
+    EXPECT_EQ(b.body.getPoints().pos, a.body.getPoints().pos);
+    ASSERT_EQ(b.polys.size(), a.polys.size());
+    for (std::size_t p = 0; p < a.polys.size(); p++) {
+        EXPECT_EQ(b.polys[p].points, a.polys[p].points);
+        EXPECT_EQ(b.polys[p].edges.size(), a.polys[p].edges.size());
+    }
+
+    // and it carries on exactly as the original would
+    a.run(200);
+    b.run(200);
+    EXPECT_EQ(b.body.getPoints().pos, a.body.getPoints().pos);
+}
+
+TEST(checkpoint, restoringInPlaceKeepsAllocations) { // NOLINT
+    SimState               s = testScene();
+    std::vector<std::byte> checkpoint;
+    s.save(checkpoint);
+    const std::byte* buffer = checkpoint.data();
+    const auto*      pos    = s.body.getPoints().pos.data();
+    const auto*      poly   = s.polys[0].points.data();
+    s.run(50);
+    s.restore(checkpoint);
+    s.save(checkpoint);
+    EXPECT_EQ(s.body.getPoints().pos.data(), pos);
+    EXPECT_EQ(s.polys[0].points.data(), poly);
+    EXPECT_EQ(checkpoint.data(), buffer);
+}
+
+TEST(checkpoint, roundTripsThroughAFile) { // NOLINT
+    SimState s = testScene();
+    s.run(100);
+    std::vector<std::byte> saved;
+    s.save(saved);
+    const std::string path =
+        (std::filesystem::temp_directory_path() / "softbody_test.ckpt").string();
+    saveCheckpointFile(path, saved);
+    std::vector<std::byte> loaded;
+    loadCheckpointFile(path, loaded);
+    std::filesystem::remove(path);
+    EXPECT_EQ(loaded, saved);
+    EXPECT_THROW(loadCheckpointFile(path, loaded), std::runtime_error);
+}
+
+TEST(checkpoint, refusesBadCheckpoints) { // NOLINT
+    SimState               s = testScene();
+    std::vector<std::byte> checkpoint;
+    s.save(checkpoint);
+    const auto pos = s.body.getPoints().pos;
+
+    std::vector<std::byte> truncated(checkpoint.begin(), checkpoint.end() - 8);
+    EXPECT_THROW(s.restore(truncated), std::runtime_error);
+    std::vector<std::byte> magic = checkpoint;
+    magic[0]                     = std::byte{'X'};
+    EXPECT_THROW(s.restore(magic), std::runtime_error);
+    EXPECT_THROW(s.restore({}), std::runtime_error);
+    EXPECT_EQ(s.body.getPoints().pos, pos); // refused before anything was touched
+
+    // a body of the other precision
+    std::vector<std::byte> other;
+    CheckpointWriter       writer(other);
+    if constexpr (sizeof(SimScalar) == sizeof(float))
+        SoftBody(Vec2I(3, 3), 0.2, {0, 0}, 8000, 100).save(writer);
+    else
+        SoftBodyF(Vec2I(3, 3), 0.2F, {0, 0}, 8000, 100).save(writer);
+    writer.finish();
+    CheckpointReader reader(other);
+    EXPECT_THROW(s.body.restore(reader), std::runtime_error);
+
+    // settings out of range on either side of their enums
+    for (const int bad: {-1, 5}) {
+        SimState corrupt        = testScene();
+        corrupt.body.integrator = static_cast<Integrator>(bad);
+        std::vector<std::byte> out;
+        corrupt.save(out);
+        EXPECT_THROW(s.restore(out), std::runtime_error);
+        corrupt.body.integrator = Integrator::symplecticEuler;
+        corrupt.collision       = static_cast<CollisionMode>(bad - 2);
+        corrupt.save(out);
+        EXPECT_THROW(s.restore(out), std::runtime_error);
+    }
+    EXPECT_EQ(s.body.getPoints().pos, pos);
+}
+
+// either refused whole or taken whole, never half restored, and the state still steps after
+TEST(checkpoint, badCheckpointLeavesStateAsItWas) { // NOLINT
+    SimState s = testScene();
+    s.run(100);
+    std::vector<std::byte> checkpoint;
+    s.save(checkpoint);
+    s.run(100);
+    const auto pos   = s.body.getPoints().pos;
+    const auto vel   = s.body.getPoints().vel;
+    const auto steps = s.steps;
+    const auto poly  = s.polys[1].points;
+
+    // one byte damaged on disk
+    std::vector<std::byte> damaged = checkpoint;
+    damaged[damaged.size() / 2] ^= std::byte{1};
+    EXPECT_THROW(s.restore(damaged), std::runtime_error);
+
+    // a body which holds together, but followed by an empty polygon, which passes the checksum
+    SimState other        = testScene();
+    other.body.integrator = Integrator::xpbd;
+    other.gravity         = -1;
+    std::vector<std::byte> bad;
+    CheckpointWriter       writer(bad);
+    other.body.save(writer);
+    writer.put(other.gravity);
+    writer.put(other.dt);
+    writer.put(other.steps);
+    writer.put(other.collision);
+    writer.put(other.sdfResolution);
+    other.adaptive.save(writer);
+    writer.put(std::uint64_t{1});
+    writer.putArray(std::span<const Vec2>());
+    writer.finish();
+    EXPECT_THROW(s.restore(bad), std::runtime_error);
+
+    EXPECT_EQ(s.body.getPoints().pos, pos);
+    EXPECT_EQ(s.body.getPoints().vel, vel);
+    EXPECT_EQ(s.body.integrator, Integrator::symplecticEuler);
+    EXPECT_EQ(s.gravity, 2.0);
+    EXPECT_EQ(s.steps, steps);
+    ASSERT_EQ(s.polys.size(), 2U);
+    EXPECT_EQ(s.polys[1].points, poly);
+    s.run(10);
+    EXPECT_EQ(s.steps, steps + 10);
+    EXPECT_TRUE(isStable(s.body.getPoints()));
+
+    s.restore(checkpoint); // and a good one is still taken after
+    EXPECT_EQ(s.steps, 100U);
+}
+
+TEST(checkpoint, resetKeepsSettings) { // NOLINT
+    SoftBody sb(Vec2I(10, 8), 0.2, {3, 0}, 8000, 100);
+    sb.integrator    = Integrator::xpbd;
+    sb.selfCollision = true;
+    std::vector<Polygon> polys{Polygon::Square(Vec2(4, 3), 0)};
+    for (int i = 0; i < 500; i++) sb.simFrame(1e-4, 2.0, polys);
+    const auto* pos = sb.getPoints().pos.data();
+    sb.reset();
+
+    SoftBody fresh(Vec2I(10, 8), 0.2, {3, 0}, 8000, 100);
+    EXPECT_EQ(sb.getPoints().pos, fresh.getPoints().pos);
+    EXPECT_EQ(sb.getPoints().vel, fresh.getPoints().vel);
+    EXPECT_EQ(sb.getSprings().size(), fresh.getSprings().size());
+    EXPECT_EQ(sb.integrator, Integrator::xpbd);
+    EXPECT_TRUE(sb.selfCollision);
+    EXPECT_EQ(sb.getPoints().pos.data(), pos);
+}
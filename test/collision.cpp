@@ -0,0 +1,58 @@
+#include "Collision.hpp"
+#include "Polygon.hpp"
+#include "gtest/gtest.h"
+#include <cmath>
+#include <random>
+
+namespace {
+
+struct Contact {
+    bool   inside;
+    Vec2   closest;
+    double dist;
+};
+
+Contact contact(const Vec2& pos, const Polygon& poly) {
+    Contact c{};
+    c.inside = polyContact(pos, poly, c.closest, c.dist);
+    return c;
+}
+
+} // namespace
+
+TEST(collision, insideSquare) { // NOLINT
+    Polygon sq = Polygon::Square(Vec2(0, 0), 0);
+    Contact c  = contact(Vec2(1, 0.2), sq);
+    EXPECT_TRUE(c.inside);
+    EXPECT_NEAR(c.dist, 0.3, 1e-12);
+    EXPECT_NEAR(c.closest.x, 1, 1e-12);
+    EXPECT_NEAR(c.closest.y, 0.5, 1e-12);
+    EXPECT_FALSE(contact(Vec2(5, 0), sq).inside);
+    EXPECT_FALSE(contact(Vec2(1, 0.6), sq).inside);
+}
+
+TEST(collision, concave) { // NOLINT
+    // an L: the notch at the top right is outside though it is within the bounds
+    Polygon l({Vec2(0, 0), Vec2(2, 0), Vec2(2, 1), Vec2(1, 1), Vec2(1, 2), Vec2(0, 2)});
+    EXPECT_TRUE(contact(Vec2(0.5, 1.5), l).inside);
+    EXPECT_TRUE(contact(Vec2(1.5, 0.5), l).inside);
+    EXPECT_FALSE(contact(Vec2(1.5, 1.5), l).inside);
+    // level with a vertex, the ray goes through it and must only count once
+    EXPECT_TRUE(contact(Vec2(0.5, 1), l).inside);
+}
+
+// the closest point is on the segment, not past its ends, and never nan near a corner, which
+// the old pythagoras based version could be
+TEST(collision, closestIsOnSurface) { // NOLINT
+    Polygon                                tri = Polygon::Triangle(Vec2(3, 3));
+    std::mt19937                           rng(3); // NOLINT
+    std::uniform_real_distribution<double> at(1.5, 4.5);
+    for (int i = 0; i < 10'000; i++) {
+        Contact c = contact(Vec2(at(rng), at(rng)), tri);
+        ASSERT_TRUE(std::isfinite(c.closest.x) && std::isfinite(c.closest.y));
+        bool onEdge = false;
+        for (const Line<double>& e: tri.edges) onEdge |= std::abs(e.side(c.closest)) < 1e-9;
+        EXPECT_TRUE(onEdge);
+        EXPECT_TRUE(tri.isBounded(c.closest));
+    }
+}
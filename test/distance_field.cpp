@@ -0,0 +1,86 @@
+#include "Broadphase.hpp"
+#include "DistanceField.hpp"
+#include "Polygon.hpp"
+#include "SimRunner.hpp"
+#include "SoftBody.hpp"
+#include "StableDt.hpp"
+#include "gtest/gtest.h"
+#include <cmath>
+#include <vector>
+
+namespace {
+
+std::vector<Polygon> scene() {
+    return {Polygon::Square(Vec2(6, 7.5), -0.75), Polygon::Triangle(Vec2(10, 8)),
+            Polygon::Triangle(Vec2(10.5, 8.5))}; // the triangles overlap
+}
+
+// error of the field against exact geometry on a fine lattice over the scene
+SdfError latticeError(const std::vector<Polygon>& polys, double resolution) {
+    DistanceField     sdf(polys, resolution);
+    PolygonGrid       grid(polys);
+    std::vector<Vec2> lattice;
+    for (double y = 5; y < 10.5; y += 0.013) {
+        for (double x = 1; x < 12; x += 0.017) lattice.emplace_back(x, y);
+    }
+    return measureSdfError(sdf, polys, grid, lattice);
+}
+
+} // namespace
+
+TEST(distanceField, closeToExact) { // NOLINT
+    SdfError err = latticeError(scene(), 16);
+    EXPECT_GT(err.samples, 10'000U);
+    EXPECT_LT(err.meanError, 0.01);
+    EXPECT_LT(err.maxError, 1.0 / 16);
+}
+
+TEST(distanceField, resolutionTradesMemoryForAccuracy) { // NOLINT
+    std::vector<Polygon> polys = scene();
+    EXPECT_LT(DistanceField(polys, 8).bytes(), DistanceField(polys, 32).bytes());
+    SdfError coarse = latticeError(polys, 4);
+    SdfError fine   = latticeError(polys, 32);
+    EXPECT_LT(fine.meanError, coarse.meanError);
+    EXPECT_LE(fine.wrongSide, coarse.wrongSide);
+}
+
+TEST(distanceField, farIsOutside) { // NOLINT
+    DistanceField sdf(scene(), 16);
+    EXPECT_TRUE(std::isinf(sdf.sample(Vec2(-50, 3)).dist));
+    EXPECT_TRUE(std::isinf(sdf.sample(Vec2(6, -20)).dist));
+    EXPECT_LT(sdf.sample(Vec2(6, 7.5)).dist, 0);
+}
+
+TEST(distanceField, rebuildsWhenPolygonsChange) { // NOLINT
+    SimState state{SimBody(Vec2I(10, 10), 0.2F, {3, 0}, 8000, 100), scene(), 2.0};
+    state.collision = CollisionMode::sdf;
+    state.step();
+    EXPECT_TRUE(state.sdf.bakedFrom(state.polys));
+
+    state.polys.push_back(Polygon::Triangle(Vec2(2, 2))); // added: picked up by the next step
+    state.step();
+    EXPECT_TRUE(state.sdf.bakedFrom(state.polys));
+
+    state.polys[0] = Polygon::Square(Vec2(6, 8), 0); // moved: needs rebuildCollision()
+    EXPECT_FALSE(state.sdf.bakedFrom(state.polys));
+    state.rebuildCollision();
+    EXPECT_TRUE(state.sdf.bakedFrom(state.polys));
+    EXPECT_LT(state.sdf.sample(Vec2(6, 8.4)).dist, 0);
+}
+
+// colliding against the field lands the body in about the same place as exact geometry
+TEST(distanceField, simulatesLikeExact) { // NOLINT
+    SimState exact{SimBody(Vec2I(20, 15), 0.2F, {3, 0}, 8000, 100), scene(), 2.0};
+    SimState baked = exact;
+    baked.collision = CollisionMode::sdf;
+    exact.run(30'000);
+    baked.run(30'000);
+    ASSERT_TRUE(isStable(baked.body.getPoints()));
+    Vec2 a;
+    Vec2 b;
+    for (const auto& p: exact.body.getPoints().pos) a += Vec2(p);
+    for (const auto& p: baked.body.getPoints().pos) b += Vec2(p);
+    const auto n = static_cast<double>(exact.body.getPoints().size());
+    EXPECT_NEAR(a.x / n, b.x / n, 0.1);
+    EXPECT_NEAR(a.y / n, b.y / n, 0.1);
+}
@@ -0,0 +1,55 @@
+#include "Integrator.hpp"
+#include "Polygon.hpp"
+#include "SoftBody.hpp"
+#include "StableDt.hpp"
+#include "gtest/gtest.h"
+#include <vector>
+
+namespace {
+
+// the stiffest body the ui allows
+SoftBody stiffBody(Integrator integrator) {
+    SoftBody sb(Vec2I(10, 10), 0.2F, Vec2(3, 0), 20000, 300);
+    sb.integrator = integrator;
+    return sb;
+}
+
+} // namespace
+
+TEST(implicit, stableAtFrameSizedSteps) { // NOLINT
+    std::vector<Polygon> polys{Polygon::Square(Vec2(4, 6), -0.75)};
+    const double         gravity = 2.0;
+    const double         simTime = 2.0;
+    for (double dt: {0.005, 0.01}) {
+        SoftBody expl = stiffBody(Integrator::symplecticEuler);
+        SoftBody impl = stiffBody(Integrator::implicitEuler);
+        EXPECT_FALSE(stableAt(expl, polys, gravity, dt, simTime, nullptr));
+        EXPECT_TRUE(stableAt(impl, polys, gravity, dt, simTime, nullptr));
+    }
+}
+
+TEST(implicit, convergesWithinTolerance) { // NOLINT
+    SoftBody sb = stiffBody(Integrator::implicitEuler);
+    for (int i = 0; i < 50; i++) {
+        sb.simFrame(0.01, 2.0, {});
+        EXPECT_GT(sb.implicit.iterations, 0);
+        EXPECT_LT(sb.implicit.iterations, sb.implicit.maxIterations);
+        EXPECT_LE(sb.implicit.residual, sb.implicit.tolerance);
+    }
+}
+
+// for small steps backward and forward euler are the same to first order
+TEST(implicit, agreesWithExplicitForSmallSteps) { // NOLINT
+    SoftBody expl = stiffBody(Integrator::symplecticEuler);
+    SoftBody impl = stiffBody(Integrator::implicitEuler);
+    for (int i = 0; i < 1000; i++) {
+        expl.simFrame(1e-5, 2.0, {});
+        impl.simFrame(1e-5, 2.0, {});
+    }
+    const Particles& a = expl.getPoints();
+    const Particles& b = impl.getPoints();
+    for (std::size_t i = 0; i < a.size(); i++) {
+        EXPECT_NEAR(a.pos[i].x, b.pos[i].x, 1e-4);
+        EXPECT_NEAR(a.pos[i].y, b.pos[i].y, 1e-4);
+    }
+}
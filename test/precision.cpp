@@ -0,0 +1,77 @@
+#include "Broadphase.hpp"
+#include "Integrator.hpp"
+#include "Polygon.hpp"
+#include "SoftBody.hpp"
+#include "StableDt.hpp"
+#include "World.hpp"
+#include "gtest/gtest.h"
+#include <cstddef>
+#include <vector>
+
+namespace {
+
+std::vector<Polygon> scene() {
+    return {Polygon::Square(Vec2(6, 7.5), -0.75), Polygon::Triangle(Vec2(10, 8))};
+}
+
+// small, so even a Debug build steps it thousands of times in a few seconds
+template <typename T>
+BasicSoftBody<T> body(Vector2<T> at = Vector2<T>(3, 0)) {
+    return {Vec2I(10, 8), 0.2F, at, 8000, 100};
+}
+
+template <typename T>
+Vec2 meanPos(const BasicSoftBody<T>& sb) {
+    Vec2 sum;
+    for (const Vector2<T>& p: sb.getPoints().pos) sum += Vec2(p);
+    return sum / static_cast<double>(sb.getPoints().size());
+}
+
+} // namespace
+
+TEST(precision, floatBodyLandsWhereDoubleDoes) { // NOLINT
+    std::vector<Polygon> polys = scene();
+    PolygonGrid          grid(polys);
+    SoftBody             reference = body<double>(Vec2(3, 4)); // lands on the platform, slides
+    SoftBodyF            fast      = body<float>(Vector2<float>(3, 4));
+    for (int i = 0; i < 15'000; i++) {
+        reference.simFrame(1e-4, 2.0, polys, nullptr, &grid);
+        fast.simFrame(1e-4, 2.0, polys, nullptr, &grid);
+    }
+    ASSERT_TRUE(isStable(fast.getPoints()));
+    const Vec2 a = meanPos(reference);
+    const Vec2 b = meanPos(fast);
+    EXPECT_NEAR(a.x, b.x, 0.05);
+    EXPECT_NEAR(a.y, b.y, 0.05);
+}
+
+TEST(precision, floatBodyIsStableWithEveryIntegrator) { // NOLINT
+    std::vector<Polygon> polys = scene();
+    const double         start = meanPos(body<float>()).y;
+    for (Integrator integrator: {Integrator::symplecticEuler, Integrator::verlet, Integrator::rk4,
+                                 Integrator::implicitEuler, Integrator::xpbd}) {
+        SCOPED_TRACE(integratorNames[static_cast<int>(integrator)]);
+        SoftBodyF sb  = body<float>();
+        sb.integrator = integrator;
+        for (int i = 0; i < 5000; i++) sb.simFrame(1e-4, 2.0, polys);
+        EXPECT_TRUE(isStable(sb.getPoints()));
+        EXPECT_GT(meanPos(sb).y, start + 0.2); // fell freely, 0.25 in the time
+    }
+}
+
+// the world runs the same float kernels as a float body
+TEST(precision, floatWorldMatchesFloatBody) { // NOLINT
+    std::vector<Polygon> polys = scene();
+    PolygonGrid          grid(polys);
+    SoftBodyF            sb = body<float>();
+    WorldF               world;
+    world.polys = polys;
+    world.simd  = sb.simd;
+    world.add(sb);
+    for (int i = 0; i < 2000; i++) {
+        sb.simFrame(world.dt, world.gravity, polys, nullptr, &grid);
+        world.step();
+    }
+    EXPECT_EQ(sb.getPoints().pos, world.getPoints().pos);
+    EXPECT_EQ(sb.getPoints().vel, world.getPoints().vel);
+}
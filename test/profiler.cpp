@@ -0,0 +1,75 @@
+#include "Polygon.hpp"
+#include "Profiler.hpp"
+#include "SoftBody.hpp"
+#include "gtest/gtest.h"
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using std::chrono::microseconds;
+
+TEST(profiler, statsOverTheWindow) { // NOLINT
+    Profiler profiler;
+    EXPECT_EQ(profiler.stats(Phase::springs).samples, 0U);
+    for (int us = 100; us >= 1; us--) profiler.add(Phase::springs, microseconds(us));
+    const PhaseStats s = profiler.stats(Phase::springs);
+    EXPECT_EQ(s.samples, 100U);
+    EXPECT_DOUBLE_EQ(s.min, 1);
+    EXPECT_DOUBLE_EQ(s.max, 100);
+    EXPECT_DOUBLE_EQ(s.p50, 50.5);
+    EXPECT_DOUBLE_EQ(s.p99, 99);
+    EXPECT_NEAR(s.avg, 50.5, 1e-3);
+    EXPECT_EQ(profiler.stats(Phase::integrate).samples, 0U); // phases are separate
+}
+
+// only the most recent window of samples count, older ones roll out
+TEST(profiler, windowRolls) { // NOLINT
+    Profiler profiler;
+    const std::size_t n = Profiler::window;
+    for (std::size_t i = 0; i < n; i++) profiler.add(Phase::step, microseconds(1000));
+    for (std::size_t i = 0; i < n; i++) profiler.add(Phase::step, microseconds(2));
+    const PhaseStats s = profiler.stats(Phase::step);
+    EXPECT_EQ(s.samples, Profiler::window);
+    EXPECT_DOUBLE_EQ(s.max, 2);
+    EXPECT_DOUBLE_EQ(s.p99, 2);
+}
+
+TEST(profiler, timersRecordIntoTheInstalledProfiler) { // NOLINT
+    Profiler profiler;
+    { const ScopedTimer nowhere(Phase::render); } // none installed, so dropped
+    {
+        const InstallProfiler installed(profiler);
+        const ScopedTimer     timer(Phase::render);
+        std::this_thread::sleep_for(microseconds(200));
+    }
+    { const ScopedTimer nowhere(Phase::render); } // uninstalled again
+    const PhaseStats s = profiler.stats(Phase::render);
+    EXPECT_EQ(s.samples, 1U);
+    EXPECT_GE(s.min, 200);
+}
+
+// a thread's profiler is its own, other threads' timers don't record into it
+TEST(profiler, installedPerThread) { // NOLINT
+    Profiler              profiler;
+    const InstallProfiler installed(profiler);
+    std::thread([] { const ScopedTimer elsewhere(Phase::display); }).join();
+    EXPECT_EQ(profiler.stats(Phase::display).samples, 0U);
+}
+
+TEST(profiler, simFrameTimesItsPhases) { // NOLINT
+#ifndef SOFTBODY_PROFILE
+    GTEST_SKIP() << "built without SOFTBODY_PROFILE";
+#endif
+    Profiler                   profiler;
+    const InstallProfiler      installed(profiler);
+    SoftBody                   sb(Vec2I(10, 8), 0.2F, {3, 0}, 8000, 100);
+    const std::vector<Polygon> polys{Polygon::Square(Vec2(4, 4), 0)};
+    sb.selfCollision = true; // the broad and narrow phases are its
+    for (int i = 0; i < 10; i++) sb.simFrame(1e-4, 2.0, polys);
+    for (Phase phase: {Phase::springs, Phase::broadphase, Phase::narrowphase, Phase::integrate,
+                       Phase::polygons}) {
+        SCOPED_TRACE(phaseNames[static_cast<std::size_t>(phase)]);
+        EXPECT_EQ(profiler.stats(phase).samples, 10U);
+    }
+    EXPECT_EQ(profiler.stats(Phase::render).samples, 0U);
+}
@@ -0,0 +1,165 @@
+#include "Checkpoint.hpp"
+#include "Recording.hpp"
+#include "SimRunner.hpp"
+#include "SoftBody.hpp"
+#include "gtest/gtest.h"
+#include "scenes.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::string tempPath(const char* name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+// Records `steps` steps of the scene to path, and returns every frame it should hold
+std::vector<std::vector<Vec2>> recordScene(const std::string& path, RecordOptions options,
+                                           std::uint64_t steps) {
+    SimState                       s = testScene();
+    std::vector<std::vector<Vec2>> expected;
+    {
+        Recorder recorder(path, s.body, s.polys, s.dt, options);
+        s.recorder = &recorder;
+        for (std::uint64_t i = 1; i <= steps; i++) {
+            s.step();
+            if (i % static_cast<std::uint64_t>(options.stride) != 0) continue;
+            std::vector<Vec2>& frame = expected.emplace_back();
+            for (const auto& p: s.body.getPoints().pos) frame.emplace_back(Vec2F(p));
+        }
+    }
+    return expected;
+}
+
+} // namespace
+
+TEST(recording, playsBackFloatPositionsExactly) { // NOLINT
+    const std::string path    = tempPath("softbody_raw.rec");
+    RecordOptions     options = {};
+    options.stride            = 3;
+    options.framesPerChunk    = 16;
+
+    const auto expected = recordScene(path, options, 200);
+    {
+        Replay replay(path);
+        ASSERT_EQ(replay.frames(), expected.size());
+        EXPECT_EQ(replay.points(), 300U);
+        EXPECT_EQ(replay.stride(), 3);
+        EXPECT_EQ(replay.polygons().size(), 2U);
+        EXPECT_EQ(replay.springs().size(), testScene().body.getSprings().size());
+        EXPECT_EQ(replay.step(0), 3U);
+        EXPECT_EQ(replay.step(20), 63U);
+        std::vector<Vec2> pos;
+        for (std::size_t f = 0; f < replay.frames(); f++) {
+            replay.frame(f, pos);
+            ASSERT_EQ(pos, expected[f]) << "frame " << f;
+        }
+    }
+    std::filesystem::remove(path);
+}
+
+TEST(recording, compressesToWithinHalfAQuantum) { // NOLINT
+    const std::string path    = tempPath("softbody_quantised.rec");
+    RecordOptions     options = {};
+    options.quantum           = 1e-4;
+    options.framesPerChunk    = 16;
+
+    const auto expected = recordScene(path, options, 100);
+    {
+        Replay replay(path);
+        ASSERT_EQ(replay.frames(), expected.size());
+        // a float frame of 300 points is 2400 bytes, and deltas of a slow body are much less
+        EXPECT_LT(replay.bytes(), expected.size() * 2400 / 2);
+        std::vector<Vec2> pos;
+        double            worst = 0;
+        for (std::size_t f = 0; f < replay.frames(); f++) {
+            replay.frame(f, pos);
+            for (std::size_t i = 0; i < pos.size(); i++)
+                worst = std::max(worst, (pos[i] - expected[f][i]).mag());
+        }
+        EXPECT_LE(worst, 1e-4 * std::sqrt(0.5) + 1e-9);
+    }
+    std::filesystem::remove(path);
+}
+
+// jumping about decodes the same as playing straight through
+TEST(recording, scrubsInAnyOrder) { // NOLINT
+    const std::string path    = tempPath("softbody_scrub.rec");
+    RecordOptions     options = {};
+    options.quantum           = 1e-3;
+    options.framesPerChunk    = 8;
+    recordScene(path, options, 50);
+    {
+        Replay                         replay(path);
+        std::vector<std::vector<Vec2>> forwards(replay.frames());
+        for (std::size_t f = 0; f < replay.frames(); f++) replay.frame(f, forwards[f]);
+        std::vector<Vec2> pos;
+        for (std::size_t f: {49U, 3U, 17U, 16U, 15U, 0U, 8U, 7U, 49U}) {
+            replay.frame(f, pos);
+            EXPECT_EQ(pos, forwards[f]) << "frame " << f;
+        }
+        EXPECT_THROW(replay.frame(50, pos), std::out_of_range);
+    }
+    std::filesystem::remove(path);
+}
+
+TEST(recording, fileCutShortKeepsItsWholeChunks) { // NOLINT
+    const std::string path    = tempPath("softbody_cut.rec");
+    RecordOptions     options = {};
+    options.framesPerChunk    = 10;
+
+    const auto expected = recordScene(path, options, 35); // chunks of 10, 10, 10 and 5
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 100);
+    {
+        Replay replay(path);
+        ASSERT_EQ(replay.frames(), 30U);
+        std::vector<Vec2> pos;
+        replay.frame(29, pos);
+        EXPECT_EQ(pos, expected[29]);
+    }
+    std::filesystem::remove(path);
+}
+
+// frames far faster than the writer keeps up with fill its queue, and wait for room, none lost
+TEST(recording, waitsForAWriterWhichFallsBehind) { // NOLINT
+    const std::string path    = tempPath("softbody_behind.rec");
+    RecordOptions     options = {};
+    options.quantum           = 1e-4;
+    options.framesPerChunk    = 1;
+
+    const SimState    s = testScene();
+    std::vector<Vec2> pos(s.body.getPoints().size());
+    {
+        Recorder recorder(path, s.body, s.polys, s.dt, options);
+        for (std::uint64_t f = 0; f < 500; f++) {
+            for (std::size_t i = 0; i < pos.size(); i++)
+                pos[i] = Vec2(static_cast<double>(i), static_cast<double>(f) * 1e-3);
+            recorder.record(f, std::span<const Vec2>(pos));
+        }
+    }
+    {
+        Replay replay(path);
+        ASSERT_EQ(replay.frames(), 500U);
+        replay.frame(499, pos);
+        EXPECT_NEAR(pos[7].x, 7, 1e-4);
+        EXPECT_NEAR(pos[7].y, 0.499, 1e-4);
+    }
+    std::filesystem::remove(path);
+}
+
+TEST(recording, refusesOtherFiles) { // NOLINT
+    const std::string      path = tempPath("softbody_not.rec");
+    std::vector<std::byte> checkpoint;
+    testScene().save(checkpoint);
+    saveCheckpointFile(path, checkpoint);
+    EXPECT_THROW(Replay{path}, std::runtime_error);
+    std::filesystem::remove(path);
+    EXPECT_THROW(Replay{path}, std::runtime_error);
+}
@@ -0,0 +1,103 @@
+#include "Integrator.hpp"
+#include "Polygon.hpp"
+#include "SoftBody.hpp"
+#include "StableDt.hpp"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace {
+
+SoftBody settled(Vec2I size) {
+    SoftBody             sb(size, 0.2, {3, 0}, 8000, 100);
+    std::vector<Polygon> polys{Polygon::Square(Vec2(4, 3), -0.75)};
+    for (int i = 0; i < 2000; i++) sb.simFrame(1e-4, 2.0, polys);
+    return sb;
+}
+
+// the points of a before and after which are in both, by grid position
+void expectKept(const SoftBody& before, const SoftBody& after) {
+    const int keepCols = std::min(before.size.x, after.size.x);
+    const int keepRows = std::min(before.size.y, after.size.y);
+    for (int y = 0; y < keepRows; y++) {
+        for (int x = 0; x < keepCols; x++) {
+            const auto a = static_cast<std::size_t>(x + y * before.size.x);
+            const auto b = static_cast<std::size_t>(x + y * after.size.x);
+            ASSERT_EQ(after.getPoints().pos[b], before.getPoints().pos[a]) << x << ", " << y;
+            ASSERT_EQ(after.getPoints().vel[b], before.getPoints().vel[a]) << x << ", " << y;
+        }
+    }
+}
+
+} // namespace
+
+TEST(resize, growingKeepsTheRunningState) { // NOLINT
+    for (Vec2I size: {Vec2I(14, 10), Vec2I(10, 14), Vec2I(14, 14), Vec2I(14, 6)}) {
+        SCOPED_TRACE(testing::Message() << size.x << " x " << size.y);
+        const SoftBody before = settled(Vec2I(10, 8));
+        SoftBody       after  = before;
+        after.resize(size);
+        EXPECT_EQ(after.getPoints().size(), static_cast<std::size_t>(size.x * size.y));
+        expectKept(before, after);
+        EXPECT_EQ(after.getSprings().size(), gridSprings(size.x, size.y, 0.2, 1, 1).size());
+    }
+}
+
+TEST(resize, shrinkingKeepsTheRunningState) { // NOLINT
+    const SoftBody before = settled(Vec2I(10, 8));
+    SoftBody       after  = before;
+    after.resize(Vec2I(6, 5));
+    expectKept(before, after);
+    after.resize(Vec2I(0, 5));
+    EXPECT_TRUE(after.getPoints().empty());
+    EXPECT_TRUE(after.getSprings().empty());
+    after.resize(Vec2I(3, 3)); // from nothing, like reset()
+    EXPECT_EQ(after.getPoints().pos, SoftBody(Vec2I(3, 3), 0.2, {3, 0}, 8000, 100).getPoints().pos);
+}
+
+// an undeformed body grows into exactly the body it would have been built as
+TEST(resize, atRestMatchesABodyBuiltThatSize) { // NOLINT
+    SoftBody       sb(Vec2I(5, 4), 0.2, {3, 0}, 8000, 100);
+    const SoftBody fresh(Vec2I(9, 7), 0.2, {3, 0}, 8000, 100);
+    sb.resize(Vec2I(9, 7));
+    ASSERT_EQ(sb.getPoints().size(), fresh.getPoints().size());
+    for (std::size_t i = 0; i < sb.getPoints().size(); i++) {
+        EXPECT_NEAR(sb.getPoints().pos[i].x, fresh.getPoints().pos[i].x, 1e-12);
+        EXPECT_NEAR(sb.getPoints().pos[i].y, fresh.getPoints().pos[i].y, 1e-12);
+    }
+    ASSERT_EQ(sb.getSprings().size(), fresh.getSprings().size());
+    for (std::size_t s = 0; s < sb.getSprings().size(); s++) {
+        EXPECT_EQ(sb.getSprings()[s].a, fresh.getSprings()[s].a);
+        EXPECT_EQ(sb.getSprings()[s].b, fresh.getSprings()[s].b);
+    }
+}
+
+// dragging the size slider from 2 to 200 one step at a time
+TEST(resize, growingStepByStepRarelyReallocates) { // NOLINT
+    SoftBody    sb(Vec2I(2, 2), 0.2, {3, 0}, 8000, 100);
+    const auto* pos = sb.getPoints().pos.data();
+    // colouring swaps the springs between two buffers, so a new one is neither of the last two
+    const Spring* springs[2] = {sb.getSprings().data(), nullptr};
+    int           moves      = 0;
+    for (int n = 3; n <= 200; n++) {
+        sb.resize(Vec2I(n, n));
+        moves += sb.getPoints().pos.data() != pos;
+        pos = sb.getPoints().pos.data();
+        const Spring* spring = sb.getSprings().data();
+        if (spring != springs[0] && spring != springs[1]) ++moves;
+        springs[1] = springs[0];
+        springs[0] = spring;
+    }
+    EXPECT_LT(moves, 60); // rather than 2 x 198
+}
+
+TEST(resize, staysStableAfterResizing) { // NOLINT
+    SoftBody             sb = settled(Vec2I(10, 8));
+    std::vector<Polygon> polys{Polygon::Square(Vec2(4, 3), -0.75)};
+    sb.resize(Vec2I(16, 12));
+    for (int i = 0; i < 2000; i++) sb.simFrame(1e-4, 2.0, polys);
+    sb.resize(Vec2I(7, 12));
+    for (int i = 0; i < 2000; i++) sb.simFrame(1e-4, 2.0, polys);
+    EXPECT_TRUE(isStable(sb.getPoints()));
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Particles.hpp"
+#include "Polygon.hpp"
+#include "SimRunner.hpp"
+#include "SoftBody.hpp"
+#include "Vector2.hpp"
+#include <cstddef>
+
+// Shared, deterministic scenes for the tests
+
+// a body of size points dropped towards a tilted platform and a triangle, as in the app. The
+// default size is small enough to step thousands of times in a test
+inline SimState testScene(Vec2I size = Vec2I(20, 15), float springConst = 8000,
+                          float dampFact = 100) {
+    return SimState{SimBody(size, 0.2F, {3, 0}, springConst, dampFact),
+                    {Polygon::Square(Vec2(6, 7.5), -0.75), Polygon::Triangle(Vec2(10, 8))},
+                    2.0};
+}
+
+// A cols x rows grid of points with positions, velocities, masses and forces perturbed so every
+// spring between them carries a different force. Built in double and narrowed, so both
+// precisions start from the same grid
+template <typename T = double>
+BasicParticles<T> jiggledGrid(int cols, int rows) {
+    BasicParticles<T> ps;
+    for (int y = 0; y < rows; y++) {
+        for (int x = 0; x < cols; x++) {
+            const Vec2  at = Vec2(x, y) * 0.2 + Vec2(0.013 * (x % 7), 0.021 * (y % 5));
+            std::size_t i  = ps.add(Vector2<T>(at), static_cast<T>(1.0 + 0.5 * (x % 2)), T(0.05));
+            ps.vel[i]      = Vector2<T>(Vec2(0.1 * (y % 4), -0.3 * (x % 3)));
+            ps.f[i]        = Vector2<T>(Vec2(x % 5, -(y % 3)));
+        }
+    }
+    return ps;
+}
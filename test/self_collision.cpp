@@ -0,0 +1,160 @@
+#include "CellList.hpp"
+#include "Particles.hpp"
+#include "ThreadPool.hpp"
+#include "Xpbd.hpp"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr float  radius = 0.05F;
+constexpr double reach  = 2 * radius;
+
+// a clump of points overlapping each other all over, plus one far away so the cells grow
+Particles clump() {
+    Particles                              ps;
+    std::mt19937                           rng(5); // NOLINT
+    std::uniform_real_distribution<double> at(0, 3);
+    for (int i = 0; i < 2000; i++) ps.add(Vec2(at(rng), at(rng)), 1.0, radius);
+    ps.add(Vec2(400, -300), 1.0, radius);
+    return ps;
+}
+
+} // namespace
+
+TEST(selfCollision, pairsMatchBruteForce) { // NOLINT
+    Particles ps = clump();
+    CellList  cells;
+    cells.build(ps.pos, reach);
+
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> found;
+    cells.forEachPair(nullptr, [&](std::uint32_t i, std::uint32_t j) {
+        found.emplace_back(std::min(i, j), std::max(i, j));
+    });
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> brute;
+    for (std::uint32_t i = 0; i < ps.size(); i++) {
+        for (std::uint32_t j = i + 1; j < ps.size(); j++) {
+            const Vec2 d = ps.pos[j] - ps.pos[i];
+            if (d.dot(d) < reach * reach) brute.emplace_back(i, j);
+        }
+    }
+    ASSERT_FALSE(brute.empty());
+    std::sort(found.begin(), found.end());
+    EXPECT_EQ(found, brute); // also, no pair twice
+}
+
+TEST(selfCollision, overlappingPointsArePushedApart) { // NOLINT
+    Particles ps;
+    ps.add(Vec2(0, 0), 1.0, radius);
+    ps.add(Vec2(0.06, 0.02), 1.0, radius);
+    CellList cells;
+    cells.build(ps.pos, reach);
+    contactForces(ps, cells, 8000, 100, nullptr);
+
+    const Vec2 d = ps.pos[1] - ps.pos[0];
+    EXPECT_LT(ps.f[0].dot(d), 0);
+    EXPECT_GT(ps.f[1].dot(d), 0);
+    EXPECT_EQ(ps.f[0] + ps.f[1], Vec2());
+}
+
+// heavily damped and flying apart, the damping would outweigh the push and pull them back
+TEST(selfCollision, separatingPointsAreNeverPulledTogether) { // NOLINT
+    Particles ps;
+    ps.add(Vec2(0, 0), 1.0, radius);
+    ps.add(Vec2(0.09, 0), 1.0, radius);
+    ps.vel[0] = Vec2(-5, 0);
+    ps.vel[1] = Vec2(5, 0);
+    CellList cells;
+    cells.build(ps.pos, reach);
+    contactForces(ps, cells, 8000, 100, nullptr);
+
+    EXPECT_EQ(ps.f[0], Vec2());
+    EXPECT_EQ(ps.f[1], Vec2());
+}
+
+TEST(selfCollision, pointsBounceOffInsteadOfPassingThrough) { // NOLINT
+    Particles ps;
+    ps.add(Vec2(0, 0), 1.0, radius);
+    ps.add(Vec2(0.2, 0), 1.0, radius);
+    ps.vel[0] = Vec2(1, 0);
+    ps.vel[1] = Vec2(-1, 0);
+    CellList cells;
+    for (int i = 0; i < 2000; i++) {
+        cells.build(ps.pos, reach);
+        contactForces(ps, cells, 8000, 0, nullptr);
+        for (std::size_t p = 0; p < ps.size(); p++) {
+            ps.vel[p] += ps.f[p] * ps.invMass[p] * 1e-4;
+            ps.pos[p] += ps.vel[p] * 1e-4;
+            ps.f[p] = Vec2();
+        }
+        EXPECT_LT(ps.pos[0].x, ps.pos[1].x);
+    }
+    EXPECT_LT(ps.vel[0].x, 0);
+    EXPECT_GT(ps.vel[1].x, 0);
+}
+
+TEST(selfCollision, independentOfPoolSize) { // NOLINT
+    Particles serial = clump();
+    Particles pooled = serial;
+    CellList  cells;
+    cells.build(serial.pos, reach);
+    ThreadPool pool(3);
+    contactForces(serial, cells, 8000, 100, nullptr);
+    contactForces(pooled, cells, 8000, 100, &pool);
+    EXPECT_EQ(serial.f, pooled.f);
+}
+
+// kept up to date step after step, the list gives the pairs of one built from scratch in the
+// same order, both when no point changes cell and when some do
+TEST(selfCollision, keptListMatchesFreshList) { // NOLINT
+    Particles                              ps;
+    std::mt19937                           rng(9); // NOLINT
+    std::uniform_real_distribution<double> at(0, 3);
+    std::uniform_real_distribution<double> nudge(-1, 1);
+    for (int i = 0; i < 2000; i++) ps.add(Vec2(at(rng), at(rng)), 1.0, radius);
+    auto pairs = [](const CellList& cells) {
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> found;
+        cells.forEachPair(nullptr, [&](std::uint32_t i, std::uint32_t j) {
+            found.emplace_back(i, j);
+        });
+        return found;
+    };
+
+    CellList kept;
+    kept.build(ps.pos, reach);
+    for (int step = 0; step < 20; step++) {
+        const double size = step % 4 == 3 ? 0.02 : 1e-9; // at times, far enough to change cell
+        for (Vec2& p: ps.pos) p += Vec2(nudge(rng), nudge(rng)) * size;
+        kept.build(ps.pos, reach);
+        CellList fresh;
+        fresh.build(ps.pos, reach);
+        ASSERT_EQ(pairs(kept), pairs(fresh)) << "step " << step;
+    }
+}
+
+TEST(selfCollision, xpbdSeparatesOverlappingPoints) { // NOLINT
+    Particles ps;
+    ps.add(Vec2(0, 0), 1.0, radius);
+    ps.add(Vec2(0.03, 0.04), 1.0, radius);
+    CellList cells;
+    cells.build(ps.pos, 1.5 * reach);
+    XpbdSolver xpbd;
+    xpbd.step(ps, {}, std::vector<std::size_t>{0}, {}, nullptr, nullptr, &cells, 0.01, Vec2(),
+              nullptr);
+    EXPECT_NEAR((ps.pos[1] - ps.pos[0]).mag(), reach, 1e-9);
+}
+
+TEST(selfCollision, blownUpPointsGiveNoPairs) { // NOLINT
+    Particles ps = clump();
+    ps.pos[7]    = Vec2(std::numeric_limits<double>::quiet_NaN(), 0);
+    CellList cells;
+    cells.build(ps.pos, reach);
+    int pairs = 0;
+    cells.forEachPair(nullptr, [&](std::uint32_t, std::uint32_t) { ++pairs; });
+    EXPECT_EQ(pairs, 0);
+}
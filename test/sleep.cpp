@@ -0,0 +1,247 @@
+#include "Checkpoint.hpp"
+#include "Integrator.hpp"
+#include "Polygon.hpp"
+#include "SimRunner.hpp"
+#include "SoftBody.hpp"
+#include "Spring.hpp"
+#include "World.hpp"
+#include "gtest/gtest.h"
+#include <cstddef>
+#include <vector>
+
+namespace {
+
+// long enough for a body dropped onto a flat square to settle
+constexpr int settleSteps = 100'000;
+
+SoftBody body(Vec2 at) { return {Vec2I(10, 8), 0.2F, at, 8000, 100}; }
+
+// steps until the body falls asleep, or n steps. Returns the steps taken
+int settle(SoftBody& sb, const std::vector<Polygon>& polys, int n = settleSteps) {
+    for (int i = 1; i <= n; i++) {
+        sb.simFrame(1e-4, 2.0, polys);
+        if (sb.sleeper.asleep()) return i;
+    }
+    return n;
+}
+
+// long and thin on a floor wider than it, so it settles a region at a time
+SoftBody longBody() { return {Vec2I(48, 4), 0.2F, {0, 0.3}, 8000, 100}; }
+const std::vector<Polygon> longFloor{
+    Polygon({Vec2(12, 2), Vec2(-2, 2), Vec2(-2, 1), Vec2(12, 1)})};
+
+// steps until some regions of sb are at rest but not all of them
+bool settlePartly(SoftBody& sb) {
+    for (int i = 0; i < settleSteps; i++) {
+        sb.simFrame(1e-4, 2.0, longFloor);
+        if (sb.restingRegions() > 0) return sb.restingRegions() < sb.regionCount();
+    }
+    return false;
+}
+
+} // namespace
+
+TEST(sleep, bodyAtRestFallsAsleepAndStops) { // NOLINT
+    const std::vector<Polygon> polys{Polygon::Square(Vec2(4, 4), 0)};
+    SoftBody                   sb = body(Vec2(3, 0));
+    sb.sleeper.enabled            = true;
+    settle(sb, polys);
+    ASSERT_TRUE(sb.sleeper.asleep());
+    EXPECT_LT(sb.sleeper.energy(), sb.sleeper.meanEnergy);
+    for (const Vec2& v: sb.getPoints().vel) EXPECT_EQ(v, Vec2());
+
+    const auto pos = sb.getPoints().pos;
+    for (int i = 0; i < 1000; i++) sb.simFrame(1e-4, 2.0, polys);
+    EXPECT_EQ(sb.getPoints().pos, pos);
+}
+
+TEST(sleep, wakingResumesTheSimulation) { // NOLINT
+    std::vector<Polygon> polys{Polygon::Square(Vec2(4, 4), 0)};
+    SoftBody             sb = body(Vec2(3, 0));
+    sb.sleeper.enabled      = true;
+    settle(sb, polys);
+    ASSERT_TRUE(sb.sleeper.asleep());
+
+    // take away what it rests on, and it falls once woken
+    polys.clear();
+    const double y = sb.getPoints().pos[0].y;
+    sb.wake();
+    for (int i = 0; i < 1000; i++) sb.simFrame(1e-4, 2.0, polys);
+    EXPECT_FALSE(sb.sleeper.asleep());
+    EXPECT_GT(sb.getPoints().pos[0].y, y);
+}
+
+TEST(sleep, disabledNeverSleeps) { // NOLINT
+    const std::vector<Polygon> polys{Polygon::Square(Vec2(4, 4), 0)};
+    SoftBody                   sb = body(Vec2(3, 0));
+    EXPECT_EQ(settle(sb, polys), settleSteps);
+    EXPECT_FALSE(sb.sleeper.asleep());
+}
+
+// a body which is still moving stays awake however long it has been going
+TEST(sleep, fallingBodyStaysAwake) { // NOLINT
+    SoftBody sb        = body(Vec2(3, 0));
+    sb.sleeper.enabled = true;
+    EXPECT_EQ(settle(sb, {}, 20'000), 20'000);
+}
+
+// until any body sleeps, a sleepy world steps exactly as one without sleeping
+TEST(sleep, worldMatchesUntilABodySleeps) { // NOLINT
+    World awake;
+    awake.polys = {Polygon::Square(Vec2(4, 4), 0)};
+    awake.add(body(Vec2(3, 0)));
+    awake.add(body(Vec2(3.5, -2)));
+    World sleepy    = awake;
+    sleepy.sleeping = true;
+    awake.run(5000);
+    sleepy.run(5000);
+    ASSERT_FALSE(sleepy.asleep(0) || sleepy.asleep(1));
+    EXPECT_EQ(sleepy.getPoints().pos, awake.getPoints().pos);
+    EXPECT_EQ(sleepy.getPoints().vel, awake.getPoints().vel);
+}
+
+TEST(sleep, worldBodyWokenByAnotherLanding) { // NOLINT
+    World world;
+    world.sleeping = true;
+    world.polys    = {Polygon::Square(Vec2(4, 4), 0)};
+    world.add(body(Vec2(3, 1.9)));
+    world.run(settleSteps);
+    ASSERT_TRUE(world.asleep(0));
+    const auto pos = world.getPoints().pos;
+    world.run(1000);
+    EXPECT_EQ(world.getPoints().pos, pos);
+
+    // dropped from just above, it lands on the sleeping one and wakes it. Any higher and the two
+    // ring against each other for several times as long before they settle
+    world.add(body(Vec2(3, 0.5)));
+    bool woken = false;
+    for (int i = 0; i < 20'000 && !woken; i++) {
+        world.step();
+        woken = !world.asleep(0);
+    }
+    EXPECT_TRUE(woken);
+    world.run(3 * settleSteps); // resting on each other rings for longer than on a polygon
+    EXPECT_TRUE(world.asleep(0));
+    EXPECT_TRUE(world.asleep(1));
+}
+
+// a body left asleep when sleeping no longer applies is simulated again, springs and all, rather
+// than falling through the floor as a heap of unsprung points
+TEST(sleep, worldBodyWakesWhenSleepingStops) { // NOLINT
+    World world;
+    world.sleeping = true;
+    world.polys    = {Polygon::Square(Vec2(4, 4), 0)};
+    world.add(body(Vec2(3, 1.9)));
+    world.run(settleSteps);
+    ASSERT_TRUE(world.asleep(0));
+    const auto pos = world.getPoints().pos;
+
+    for (Integrator integrator: {Integrator::symplecticEuler, Integrator::verlet,
+                                 Integrator::rk4}) {
+        SCOPED_TRACE(integratorNames[static_cast<int>(integrator)]);
+        World w      = world;
+        w.integrator = integrator;
+        w.sleeping   = integrator != Integrator::symplecticEuler;
+        w.run(5000);
+        EXPECT_FALSE(w.asleep(0));
+        for (std::size_t i = 0; i < pos.size(); i++)
+            EXPECT_LT((w.getPoints().pos[i] - pos[i]).mag(), 0.01) << i;
+    }
+}
+
+TEST(sleep, softBodyWakesWhenDisabled) { // NOLINT
+    const std::vector<Polygon> polys{Polygon::Square(Vec2(4, 4), 0)};
+    SoftBody                   sb = body(Vec2(3, 0));
+    sb.sleeper.enabled            = true;
+    settle(sb, polys);
+    ASSERT_TRUE(sb.sleeper.asleep());
+    sb.sleeper.enabled = false;
+    sb.simFrame(1e-4, 2.0, polys);
+    EXPECT_FALSE(sb.sleeper.asleep());
+    EXPECT_NE(sb.getPoints().vel, std::vector<Vec2>(sb.getPoints().size())); // moving again
+}
+
+TEST(sleep, checkpointKeepsTheSleepState) { // NOLINT
+    SimState s{SimBody(Vec2I(10, 8), 0.2F, {3, 0}, 8000, 100), {Polygon::Square(Vec2(4, 4), 0)},
+               2.0};
+    s.body.sleeper.enabled = true;
+    for (int i = 0; i < settleSteps && !s.body.sleeper.asleep(); i++) s.step();
+    ASSERT_TRUE(s.body.sleeper.asleep());
+    std::vector<std::byte> checkpoint;
+    s.save(checkpoint);
+
+    s.body.wake();
+    s.body.sleeper.enabled = false;
+    s.run(100);
+    s.restore(checkpoint);
+    EXPECT_TRUE(s.body.sleeper.enabled);
+    EXPECT_TRUE(s.body.sleeper.asleep());
+    const auto pos = s.body.getPoints().pos;
+    s.run(100);
+    EXPECT_EQ(s.body.getPoints().pos, pos);
+}
+
+// a large body rests a region at a time, the regions at rest held exactly where they are while
+// the rest of it carries on, and until the first one rests it steps as it would without them
+TEST(sleep, largeBodyRestsInRegions) { // NOLINT
+    SoftBody sb        = longBody();
+    SoftBody plain     = longBody();
+    sb.sleeper.enabled = true;
+    ASSERT_EQ(sb.regionCount(), 6U);
+    while (sb.restingRegions() == 0) {
+        sb.simFrame(1e-4, 2.0, longFloor);
+        plain.simFrame(1e-4, 2.0, longFloor);
+        ASSERT_EQ(sb.getPoints().pos, plain.getPoints().pos); // resting only zeroes velocities
+    }
+    ASSERT_LT(sb.restingRegions(), sb.regionCount());
+
+    const std::size_t resting = sb.restingRegions();
+    const auto        pos     = sb.getPoints().pos;
+    for (int i = 0; i < 100; i++) sb.simFrame(1e-4, 2.0, longFloor);
+    ASSERT_GE(sb.restingRegions(), resting);
+    std::size_t held = 0;
+    for (std::size_t i = 0; i < pos.size(); i++) {
+        if (sb.getPoints().pos[i] == pos[i]) held++;
+    }
+    EXPECT_GE(held, resting * 8 * 4); // regions 8 points wide, the body's 4 rows deep
+    EXPECT_LT(held, pos.size());      // while the rest still moves
+
+    for (int i = 0; i < settleSteps && !sb.sleeper.asleep(); i++)
+        sb.simFrame(1e-4, 2.0, longFloor);
+    EXPECT_TRUE(sb.sleeper.asleep());
+}
+
+// pulled on hard by an awake neighbour, a region at rest wakes rather than tearing the body
+TEST(sleep, regionWokenByItsNeighbour) { // NOLINT
+    SoftBody sb        = longBody();
+    sb.sleeper.enabled = true;
+    ASSERT_TRUE(settlePartly(sb));
+    // gravity reversed, which only the awake regions feel until the others are woken
+    for (int i = 0; i < 200; i++) sb.simFrame(1e-4, -20.0, longFloor);
+    EXPECT_EQ(sb.restingRegions(), 0U);
+    const auto& ps = sb.getPoints();
+    for (const Spring& s: sb.getSprings())
+        EXPECT_LT((ps.pos[s.b] - ps.pos[s.a]).mag(), 1.5 * s.rest) << s.a << ' ' << s.b;
+}
+
+// the regions at rest are part of the checkpoint, so a restored body carries on the same
+TEST(sleep, checkpointKeepsTheRegions) { // NOLINT
+    SoftBody sb        = longBody();
+    sb.sleeper.enabled = true;
+    ASSERT_TRUE(settlePartly(sb));
+    std::vector<std::byte> checkpoint;
+    CheckpointWriter       writer(checkpoint);
+    sb.save(writer);
+    writer.finish();
+
+    SoftBody         restored = longBody();
+    CheckpointReader reader(checkpoint);
+    restored.restore(reader);
+    EXPECT_EQ(restored.restingRegions(), sb.restingRegions());
+    for (int i = 0; i < 1000; i++) {
+        sb.simFrame(1e-4, 2.0, longFloor);
+        restored.simFrame(1e-4, 2.0, longFloor);
+    }
+    EXPECT_EQ(restored.getPoints().pos, sb.getPoints().pos);
+    EXPECT_EQ(restored.restingRegions(), sb.restingRegions());
+}
@@ -0,0 +1,49 @@
+#include "Particles.hpp"
+#include "Spring.hpp"
+#include "SpringKernel.hpp"
+#include "ThreadPool.hpp"
+#include "gtest/gtest.h"
+#include "scenes.hpp"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+TEST(spring, gridSpringCount) { // NOLINT
+    // right + down + two diagonals per interior cell
+    EXPECT_EQ(gridSprings(3, 2, 1.0, 1.0, 1.0).size(), 2 * 2 + 3 * 1 + 2 * 2 * 1);
+    EXPECT_TRUE(gridSprings(0, 5, 1.0, 1.0, 1.0).empty());
+}
+
+TEST(spring, colourBatchesAreConflictFree) { // NOLINT
+    std::vector<Spring>      springs = gridSprings(17, 11, 0.2, 8000, 100);
+    std::size_t              count   = springs.size();
+    std::vector<std::size_t> batches = colourSprings(springs, 17 * 11);
+    ASSERT_EQ(springs.size(), count);
+    ASSERT_EQ(batches.back(), count);
+    for (std::size_t c = 0; c + 1 < batches.size(); c++) {
+        std::vector<bool> seen(17 * 11);
+        for (std::size_t i = batches[c]; i < batches[c + 1]; i++) {
+            EXPECT_FALSE(seen[springs[i].a]);
+            EXPECT_FALSE(seen[springs[i].b]);
+            seen[springs[i].a] = seen[springs[i].b] = true;
+        }
+    }
+}
+
+TEST(spring, parallelMatchesSerialExactly) { // NOLINT
+    const int                cols = 64;
+    const int                rows = 48;
+    std::vector<Spring>      springs = gridSprings(cols, rows, 0.2, 8000, 100);
+    std::vector<std::size_t> batches = colourSprings(springs, cols * rows);
+
+    Particles serial = jiggledGrid(cols, rows);
+    springForces(serial, springs);
+
+    for (unsigned threads: {1U, 2U, 3U, 8U}) {
+        Particles  parallel = jiggledGrid(cols, rows);
+        ThreadPool pool(threads);
+        springForces(parallel, springs, batches, pool, Simd::scalar);
+        SCOPED_TRACE("threads = " + std::to_string(threads));
+        EXPECT_EQ(parallel.f, serial.f); // bit identical, not just close
+    }
+}
@@ -0,0 +1,103 @@
+#include "Particles.hpp"
+#include "Spring.hpp"
+#include "SpringKernel.hpp"
+#include "ThreadPool.hpp"
+#include "gtest/gtest.h"
+#include "scenes.hpp"
+#include <cmath>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace {
+
+// every level this build and CPU can run
+std::vector<Simd> levels() {
+    std::vector<Simd> result{Simd::scalar};
+    if (detectSimd() != Simd::scalar) result.push_back(Simd::sse2);
+    if (detectSimd() == Simd::avx2) result.push_back(Simd::avx2);
+    return result;
+}
+
+} // namespace
+
+TEST(springKernel, springForcesMatchScalar) { // NOLINT
+    // odd sizes so the spring count is not a multiple of the vector width
+    std::vector<Spring> springs = gridSprings(23, 19, 0.2, 8000, 100);
+    Particles           scalar  = jiggledGrid(23, 19);
+    springForces(scalar, springs);
+
+    for (Simd simd: levels()) {
+        SCOPED_TRACE(simdName(simd));
+        Particles ps = jiggledGrid(23, 19);
+        springForces(ps, springs, simd);
+        for (std::size_t i = 0; i < ps.size(); i++) {
+            // sqrt vs hypot: within a few ulps of the largest force
+            EXPECT_NEAR(ps.f[i].x, scalar.f[i].x, 1e-9);
+            EXPECT_NEAR(ps.f[i].y, scalar.f[i].y, 1e-9);
+        }
+    }
+}
+
+TEST(springKernel, integrateMatchesScalarExactly) { // NOLINT
+    Particles scalar = jiggledGrid(13, 7);
+    integrate(scalar, 3, scalar.size() - 2, 1e-3, Vec2(0, 2), Simd::scalar);
+
+    for (Simd simd: levels()) {
+        SCOPED_TRACE(simdName(simd));
+        Particles ps = jiggledGrid(13, 7);
+        integrate(ps, 3, ps.size() - 2, 1e-3, Vec2(0, 2), simd);
+        EXPECT_EQ(ps.pos, scalar.pos);
+        EXPECT_EQ(ps.vel, scalar.vel);
+        EXPECT_EQ(ps.f, scalar.f);
+    }
+}
+
+TEST(springKernel, batchedIndependentOfThreadCount) { // NOLINT
+    std::vector<Spring>      springs = gridSprings(61, 37, 0.2, 8000, 100);
+    std::vector<std::size_t> batches = colourSprings(springs, 61 * 37);
+
+    for (Simd simd: levels()) {
+        Particles serial = jiggledGrid(61, 37);
+        springForces(serial, springs, simd);
+        for (unsigned threads: {1U, 3U, 4U}) {
+            SCOPED_TRACE(std::string(simdName(simd)) + " threads = " + std::to_string(threads));
+            Particles  ps = jiggledGrid(61, 37);
+            ThreadPool pool(threads);
+            springForces(ps, springs, batches, pool, simd);
+            EXPECT_EQ(ps.f, serial.f);
+        }
+    }
+}
+
+TEST(springKernel, floatSpringForcesMatchScalar) { // NOLINT
+    // 4 and 8 wide, so a different remainder again
+    std::vector<SpringF> springs = gridSprings<float>(23, 19, 0.2F, 8000, 100);
+    ParticlesF           scalar  = jiggledGrid<float>(23, 19);
+    springForces(scalar, springs);
+
+    for (Simd simd: levels()) {
+        SCOPED_TRACE(simdName(simd));
+        ParticlesF ps = jiggledGrid<float>(23, 19);
+        springForces(ps, springs, simd);
+        for (std::size_t i = 0; i < ps.size(); i++) {
+            // a few float ulps of forces in the hundreds
+            EXPECT_NEAR(ps.f[i].x, scalar.f[i].x, 1e-3);
+            EXPECT_NEAR(ps.f[i].y, scalar.f[i].y, 1e-3);
+        }
+    }
+}
+
+TEST(springKernel, floatIntegrateMatchesScalarExactly) { // NOLINT
+    ParticlesF scalar = jiggledGrid<float>(13, 7);
+    integrate(scalar, 3, scalar.size() - 2, 1e-3F, Vec2F(0, 2), Simd::scalar);
+
+    for (Simd simd: levels()) {
+        SCOPED_TRACE(simdName(simd));
+        ParticlesF ps = jiggledGrid<float>(13, 7);
+        integrate(ps, 3, ps.size() - 2, 1e-3F, Vec2F(0, 2), simd);
+        EXPECT_EQ(ps.pos, scalar.pos);
+        EXPECT_EQ(ps.vel, scalar.vel);
+        EXPECT_EQ(ps.f, scalar.f);
+    }
+}
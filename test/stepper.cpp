@@ -0,0 +1,63 @@
+#include "SimRunner.hpp"
+#include "SoftBody.hpp"
+#include "Stepper.hpp"
+#include "ThreadPool.hpp"
+#include "gtest/gtest.h"
+#include "scenes.hpp"
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <thread>
+#include <utility>
+#include <vector>
+
+TEST(stepper, drainsWholeSteps) { // NOLINT
+    FixedStepper stepper(0.01, 100);
+    EXPECT_EQ(stepper.advance(0.025), 2);
+    EXPECT_NEAR(stepper.alpha(), 0.5, 1e-9);
+    EXPECT_EQ(stepper.advance(0.004), 0);
+    EXPECT_EQ(stepper.advance(0.002), 1); // the remainders add up
+    EXPECT_NEAR(stepper.alpha(), 0.1, 1e-9);
+}
+
+TEST(stepper, capsCatchUp) { // NOLINT
+    FixedStepper stepper(0.001, 5);
+    EXPECT_EQ(stepper.advance(1.0), 5); // a long stall does not queue up a thousand steps
+    EXPECT_LT(stepper.alpha(), 1.0);
+    EXPECT_EQ(stepper.advance(0.0), 0);
+}
+
+TEST(stepper, offlineRunsAreDeterministic) { // NOLINT
+    SimState a = testScene(Vec2I(40, 30));
+    SimState b = testScene(Vec2I(40, 30));
+    a.run(1500);
+    b.run(1500);
+    EXPECT_EQ(a.steps, 1500);
+    ASSERT_FALSE(std::isnan(a.body.getPoints().pos[0].x));
+    EXPECT_EQ(a.body.getPoints().pos, b.body.getPoints().pos);
+    EXPECT_EQ(a.body.getPoints().vel, b.body.getPoints().vel);
+
+    // and the same again spread over threads
+    ThreadPool pool(3);
+    SimState   c = testScene(Vec2I(40, 30));
+    c.pool       = &pool;
+    c.run(1500);
+    EXPECT_EQ(a.body.getPoints().pos, c.body.getPoints().pos);
+}
+
+// paused, the simulation thread should sleep between looks at its queue, not spin on the clock
+TEST(stepper, pausedRunnerIdles) { // NOLINT
+    SimState s = testScene(Vec2I(40, 30));
+    s.paused   = true;
+    SimRunner runner(std::move(s));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50)); // past starting up
+
+    using clock_type        = std::chrono::steady_clock;
+    const std::clock_t cpu  = std::clock(); // of the whole process, so including the runner
+    const auto         wall = clock_type::now();
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    const double cpuSeconds  = static_cast<double>(std::clock() - cpu) / CLOCKS_PER_SEC;
+    const double wallSeconds = std::chrono::duration<double>(clock_type::now() - wall).count();
+    EXPECT_LT(cpuSeconds, wallSeconds / 4);
+    EXPECT_EQ(runner.latest().steps, 0U);
+}
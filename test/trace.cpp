@@ -0,0 +1,121 @@
+#include "Profiler.hpp"
+#include "ThreadPool.hpp"
+#include "Trace.hpp"
+#include "gtest/gtest.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace {
+
+std::string json(const Tracer& tracer) {
+    std::ostringstream out;
+    tracer.write(out);
+    return out.str();
+}
+
+std::size_t count(const std::string& s, const std::string& what) {
+    std::size_t n = 0;
+    for (auto at = s.find(what); at != std::string::npos; at = s.find(what, at + 1)) n++;
+    return n;
+}
+
+void event(Tracer& tracer, const char* name) {
+    const auto now = std::chrono::steady_clock::now();
+    tracer.record(name, now, now + std::chrono::microseconds(5));
+}
+
+} // namespace
+
+TEST(trace, scopesAndTimersBecomeEvents) { // NOLINT
+#ifndef SOFTBODY_PROFILE
+    GTEST_SKIP() << "built without SOFTBODY_PROFILE";
+#endif
+    Tracer tracer;
+    { SOFTBODY_TRACE("Before"); } // not active yet
+    tracer.start();
+    EXPECT_TRUE(tracer.active());
+    {
+        SOFTBODY_TRACE("Outer");
+        SOFTBODY_TIME(Phase::springs); // with no profiler installed, still traced
+    }
+    tracer.stop();
+    { SOFTBODY_TRACE("After"); }
+    const std::string out = json(tracer);
+    EXPECT_EQ(out.rfind(R"({"displayTimeUnit":"ns","traceEvents":[)", 0), 0U);
+    EXPECT_EQ(count(out, R"("ph":"X")"), 2U);
+    EXPECT_EQ(count(out, R"("name":"Outer")"), 1U);
+    EXPECT_EQ(count(out, R"("name":"Springs")"), 1U);
+    EXPECT_EQ(count(out, "Before") + count(out, "After"), 0U);
+}
+
+TEST(trace, ringKeepsTheMostRecent) { // NOLINT
+    static constexpr std::array<const char*, 10> names = {"e0", "e1", "e2", "e3", "e4",
+                                                          "e5", "e6", "e7", "e8", "e9"};
+    Tracer tracer(4);
+    for (const char* name: names) event(tracer, name);
+    const std::string out = json(tracer);
+    EXPECT_EQ(count(out, R"("ph":"X")"), 4U);
+    for (std::size_t i = 0; i < names.size(); i++)
+        EXPECT_EQ(count(out, '"' + std::string(names[i]) + '"'), i >= 6 ? 1U : 0U) << names[i];
+}
+
+TEST(trace, eachThreadItsOwnTrack) { // NOLINT
+    Tracer tracer;
+    nameTraceThread("Main");
+    event(tracer, "here");
+    std::thread([&] {
+        nameTraceThread("Other");
+        event(tracer, "there");
+    }).join();
+    EXPECT_EQ(tracer.threads(), 2U);
+    const std::string out = json(tracer);
+    EXPECT_EQ(count(out, R"("ph":"M")"), 2U);
+    EXPECT_EQ(count(out, R"("name":"Main")"), 1U);
+    EXPECT_EQ(count(out, R"("name":"Other")"), 1U);
+    EXPECT_EQ(count(out, R"("tid":1)"), 2U); // its name and its event
+    EXPECT_EQ(count(out, R"("tid":2)"), 2U);
+    nameTraceThread("");
+}
+
+TEST(trace, poolWorkersAreTraced) { // NOLINT
+#ifndef SOFTBODY_PROFILE
+    GTEST_SKIP() << "built without SOFTBODY_PROFILE";
+#endif
+    Tracer tracer;
+    tracer.start();
+    {
+        ThreadPool            pool(3);
+        std::atomic<unsigned> sum{0};
+        pool.parallelFor(
+            3000, [&](std::size_t begin, std::size_t end) {
+                sum += static_cast<unsigned>(end - begin);
+            });
+        EXPECT_EQ(sum, 3000U);
+    }
+    tracer.stop();
+    const std::string out = json(tracer);
+    EXPECT_EQ(count(out, R"("name":"Chunk")"), 3U);
+    EXPECT_EQ(count(out, R"("name":"Worker 1")"), 1U);
+    EXPECT_EQ(count(out, R"("name":"Worker 2")"), 1U);
+}
+
+// writing while another thread is still recording gives whole events only
+TEST(trace, writeWhileRecording) { // NOLINT
+    Tracer            tracer(64);
+    std::atomic<bool> done{false};
+    std::thread       writer([&] {
+        while (!done) event(tracer, "busy");
+    });
+    for (int i = 0; i < 200; i++) {
+        const std::string out = json(tracer);
+        EXPECT_EQ(count(out, R"("ph":"X")"), count(out, R"("name":"busy")"));
+        EXPECT_LE(count(out, R"("ph":"X")"), 64U);
+    }
+    done = true;
+    writer.join();
+}
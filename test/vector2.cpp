@@ -2,6 +2,7 @@
 #include "gtest/gtest.h"
 #include <limits>
 #include <numbers>
+#include <type_traits>
 
 using std::numbers::sqrt2;
 static constexpr double inv_sqrt2 = sqrt2 / 2.0;
@@ -34,3 +35,8 @@ TEST(vector2, normalizedUnitVector) { // NOLINT
     EXPECT_NEAR(norm.x, answer.x, std::numeric_limits<double>::epsilon());
     EXPECT_NEAR(norm.y, answer.y, std::numeric_limits<double>::epsilon());
 }
+TEST(vector2, keepsItsPrecision) { // NOLINT
+    static_assert(std::is_same_v<decltype(Vec2F().dot(Vec2F())), float>);
+    static_assert(std::is_same_v<decltype(Vec2F() * 2.0F), Vec2F>);
+    EXPECT_EQ(Vec2F(Vec2(0.5, -2)), Vec2F(0.5F, -2.0F));
+}
@@ -0,0 +1,132 @@
+#include "Broadphase.hpp"
+#include "Collision.hpp"
+#include "Polygon.hpp"
+#include "SoftBody.hpp"
+#include "StableDt.hpp"
+#include "ThreadPool.hpp"
+#include "World.hpp"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace {
+
+SoftBody body(Vec2I size, float gap, Vec2 at) { return {size, gap, at, 8000, 100}; }
+
+// one body dropped onto another which is just above a platform
+World stack(bool contacts) {
+    World world;
+    world.contacts = contacts;
+    world.polys    = {Polygon::Square(Vec2(2, 8), 0)};
+    world.add(body(Vec2I(20, 8), 0.1F, Vec2(1, 6.75)));
+    world.add(body(Vec2I(20, 8), 0.1F, Vec2(1.05, 5.9)));
+    return world;
+}
+
+double meanY(const World& world, std::size_t b) {
+    double sum = 0;
+    for (const Vec2& p: world.positions(b)) sum += p.y;
+    return sum / static_cast<double>(world.positions(b).size());
+}
+
+// the outline of a cols x rows body b, wound as Polygon::Square is
+Polygon outline(const World& world, std::size_t b, int cols, int rows) {
+    const std::span<const Vec2> pos = world.positions(b);
+    auto at = [&](int x, int y) { return pos[static_cast<std::size_t>(x + y * cols)]; };
+    std::vector<Vec2> points;
+    for (int x = cols - 1; x > 0; x--) points.push_back(at(x, rows - 1));
+    for (int y = rows - 1; y > 0; y--) points.push_back(at(0, y));
+    for (int x = 0; x < cols - 1; x++) points.push_back(at(x, 0));
+    for (int y = 0; y < rows - 1; y++) points.push_back(at(cols - 1, y));
+    return Polygon(points);
+}
+
+// points of body a inside the outline of body b
+int inside(const World& world, std::size_t a, std::size_t b, Vec2I size) {
+    const Polygon poly  = outline(world, b, size.x, size.y);
+    int           count = 0;
+    for (const Vec2& p: world.positions(a)) {
+        Vec2   closest;
+        double dist = 0;
+        if (polyContact(p, poly, closest, dist)) count++;
+    }
+    return count;
+}
+
+} // namespace
+
+TEST(world, bodiesAreRangesOfTheSharedPool) { // NOLINT
+    World world;
+    world.reserve(3, 3 * 20, 3 * 60);
+    for (int i = 0; i < 3; i++) world.add(body(Vec2I(5, 4), 0.2F, Vec2(3.0 * i, 0)));
+    ASSERT_EQ(world.getBodies().size(), 3U);
+    EXPECT_EQ(world.getPoints().size(), 60U);
+    for (const World::Body& b: world.getBodies()) {
+        for (std::size_t s = b.firstSpring; s < b.firstSpring + b.springCount; s++) {
+            const Spring& spring = world.getSprings()[s];
+            EXPECT_GE(std::min(spring.a, spring.b), b.firstPoint);
+            EXPECT_LT(std::max(spring.a, spring.b), b.firstPoint + b.pointCount);
+        }
+    }
+    EXPECT_EQ(world.positions(2)[0], Vec2(6, 0));
+}
+
+// a world of one body is exactly that body stepped on its own
+TEST(world, singleBodyMatchesSoftBody) { // NOLINT
+    std::vector<Polygon> polys{Polygon::Square(Vec2(4, 6), -0.75)};
+    PolygonGrid          grid(polys);
+    SoftBody             sb = body(Vec2I(12, 8), 0.2F, Vec2(3, 0));
+    sb.selfCollision        = true; // as the world's contacts are
+    World                world;
+    world.polys = polys;
+    world.simd  = sb.simd;
+    world.add(sb);
+    for (int i = 0; i < 2000; i++) {
+        sb.simFrame(world.dt, world.gravity, polys, nullptr, &grid);
+        world.step();
+    }
+    EXPECT_EQ(sb.getPoints().pos, world.getPoints().pos);
+    EXPECT_EQ(sb.getPoints().vel, world.getPoints().vel);
+}
+
+TEST(world, bodiesCollideWithEachOther) { // NOLINT
+    World      apart   = stack(true);
+    World      through = stack(false);
+    ThreadPool pool(3);
+    apart.run(20'000, &pool);
+    through.run(20'000, &pool);
+    ASSERT_TRUE(isStable(apart.getPoints()));
+    // +y is down. On top of the other, rather than fallen through into it
+    EXPECT_LT(meanY(apart, 1), meanY(apart, 0) - 0.5);
+    EXPECT_GT(meanY(through, 1), meanY(through, 0) - 0.2);
+}
+
+// bodies of the app's own size and spacing, with points far smaller than the gaps between them,
+// still land on each other rather than in each other
+TEST(world, defaultBodiesDontInterpenetrate) { // NOLINT
+    const Vec2I size(10, 8);
+    World       world;
+    world.polys = {Polygon::Square(Vec2(4, 4), 0)};
+    world.add(body(size, 0.2F, Vec2(3, 2)));
+    world.add(body(size, 0.2F, Vec2(3.1, -2)));
+    for (int i = 1; i <= 20'000; i++) {
+        world.step();
+        if (i % 100 == 0) {
+            ASSERT_EQ(inside(world, 1, 0, size), 0) << i;
+            ASSERT_EQ(inside(world, 0, 1, size), 0) << i;
+        }
+    }
+    EXPECT_LT(meanY(world, 1), meanY(world, 0) - 1); // +y is down, so on top
+}
+
+TEST(world, independentOfPoolSize) { // NOLINT
+    World      serial = stack(true);
+    World      pooled = stack(true);
+    ThreadPool pool(3);
+    serial.run(5000);
+    pooled.run(5000, &pool);
+    EXPECT_EQ(serial.getPoints().pos, pooled.getPoints().pos);
+    EXPECT_EQ(serial.getPoints().vel, pooled.getPoints().vel);
+}
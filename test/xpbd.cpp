@@ -0,0 +1,80 @@
+#include "Collision.hpp"
+#include "Integrator.hpp"
+#include "Polygon.hpp"
+#include "SoftBody.hpp"
+#include "StableDt.hpp"
+#include "ThreadPool.hpp"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace {
+
+SoftBody xpbdBody(double k, Vec2I size = Vec2I(10, 10)) {
+    SoftBody sb(size, 0.2F, Vec2(3, 0), k, 100);
+    sb.integrator = Integrator::xpbd;
+    return sb;
+}
+
+double maxStretch(const SoftBody& sb) {
+    const Particles& ps      = sb.getPoints();
+    double           stretch = 0;
+    for (const Spring& s: sb.getSprings())
+        stretch = std::max(stretch, std::abs((ps.pos[s.a] - ps.pos[s.b]).mag() / s.rest - 1));
+    return stretch;
+}
+
+} // namespace
+
+// lands on a platform at a 60 Hz step and stays there in one piece
+TEST(xpbd, stableAtFrameSteps) { // NOLINT
+    std::vector<Polygon> polys{Polygon::Square(Vec2(4, 6), 0)};
+    SoftBody             sb = xpbdBody(8000);
+    for (int i = 0; i < 180; i++) sb.simFrame(1.0 / 60, 2.0, polys);
+    ASSERT_TRUE(isStable(sb.getPoints()));
+    EXPECT_LT(maxStretch(sb), 0.1);
+    for (const Vec2& pos: sb.getPoints().pos) {
+        Vec2   closest;
+        double dist = 0;
+        EXPECT_FALSE(polyContact(pos, polys[0], closest, dist) && dist > 1e-6);
+    }
+}
+
+// stiffer springs, stiffer body: it sags less under gravity
+TEST(xpbd, springConstantSetsStiffness) { // NOLINT
+    std::vector<Polygon> polys{Polygon::Square(Vec2(4, 6), 0)};
+    SoftBody             soft  = xpbdBody(1000);
+    SoftBody             stiff = xpbdBody(1e6);
+    for (int i = 0; i < 180; i++) {
+        soft.simFrame(1.0 / 60, 2.0, polys);
+        stiff.simFrame(1.0 / 60, 2.0, polys);
+    }
+    EXPECT_GT(maxStretch(soft), 2 * maxStretch(stiff));
+}
+
+// each spring by its own k, rather than by the body's springConst, which both share
+TEST(xpbd, eachSpringKeepsItsOwnStiffness) { // NOLINT
+    std::vector<Polygon> polys{Polygon::Square(Vec2(4, 6), 0)};
+    SoftBody             soft  = xpbdBody(8000);
+    SoftBody             stiff = xpbdBody(8000);
+    for (Spring& s: soft.getSprings()) s.k = 1000;
+    for (Spring& s: stiff.getSprings()) s.k = 1e6;
+    for (int i = 0; i < 180; i++) {
+        soft.simFrame(1.0 / 60, 2.0, polys);
+        stiff.simFrame(1.0 / 60, 2.0, polys);
+    }
+    EXPECT_GT(maxStretch(soft), 2 * maxStretch(stiff));
+}
+
+TEST(xpbd, parallelMatchesSerialExactly) { // NOLINT
+    std::vector<Polygon> polys{Polygon::Square(Vec2(6, 7.5), 0.5)};
+    SoftBody             serial   = xpbdBody(8000, Vec2I(40, 30));
+    SoftBody             parallel = xpbdBody(8000, Vec2I(40, 30));
+    ThreadPool           pool(3);
+    for (int i = 0; i < 60; i++) {
+        serial.simFrame(1.0 / 60, 2.0, polys);
+        parallel.simFrame(1.0 / 60, 2.0, polys, &pool);
+    }
+    EXPECT_EQ(serial.getPoints().pos, parallel.getPoints().pos);
+}